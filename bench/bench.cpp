@@ -0,0 +1,366 @@
+// --- НАБОР ЗАМЕРОВ ---
+// Генераторы синтетических программ, размер которых растёт с --scale, и микрозамеры отдельных этапов на каждой:
+//   lex   - только Lexer::getNextToken до TOKEN_EOF (лексемы в секунду)
+//   parse - Parser::parse, лексер внутри него (элементы ОПС в секунду)
+//   pparse - parseParallel на --compile-threads=N потоках, только с этим флагом; ОПС сверяется с parse по хешу
+//   edit  - IncrementalCompiler::compile после замены одной цифры в середине текста (операторы, разобранные заново)
+//   opt   - optimizeOPS, только с -O (элементы ОПС в секунду)
+//   run   - Interpreter::run готовой ОПС (инструкции в секунду)
+// Каждый замер повторяется --repeat раз, в отчёт идут минимум и медиана. JSON (--json=FILE) имеет постоянный
+// порядок полей и строк, и два файла разных версий сравнивает bench/compare.py.
+//
+// Запуск: translator-bench [--scale=N] [--repeat=N] [--filter=подстрока] [-O] [--compile-threads=N] [--json=FILE] [--emit=DIR]
+// --emit=DIR только записывает сгенерированные программы в DIR/<имя>.txt - для запуска interpreter на них.
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+#include "interpreter.h"
+#include "fragments.h"
+using namespace std;
+using namespace translator::detail;
+
+// --- ГЕНЕРАТОРЫ ---
+// Все программы без read() и без переполнений int: значения ограничены делением, результат печатается,
+// чтобы оптимизатор не выбросил вычисления как мёртвый код.
+
+// Вложенные if/else глубиной 300 * scale: рекурсия парсера и цепочки меток; при выполнении условия истинны до самого дна
+string nestedIfProgram(int scale)
+{
+    int depth = 300 * scale;
+    string text = "x = 20;\ns = 0;\ni = 200;\nwhile (i > 0) {\n";
+    for (int k = 0; k < depth; ++k)
+        text += "if (x > " + to_string(k % 13) + ") { s = s / 2 + " + to_string(k % 9) + ";\n";
+    for (int k = depth - 1; k >= 0; --k)
+        text += "} else { s = s / 2 - " + to_string(k % 5) + "; };\n";
+    return text + "i = i - 1;\n};\nprint(s);\n";
+}
+
+// Одно выражение из 5000 * scale слагаемых со скобками, умножением и делением на константы
+string longExpressionProgram(int scale)
+{
+    int terms = 5000 * scale;
+    string expression = "x";
+    for (int k = 1; k < terms; ++k)
+    {
+        string c = to_string(k % 7 + 1);
+        switch (k % 4)
+        {
+        case 0:
+            expression += " + x * " + c;
+            break;
+        case 1:
+            expression += " - x / " + c;
+            break;
+        case 2:
+            expression += " + (x - " + c + ") * 2";
+            break;
+        default:
+            expression += " - " + c;
+            break;
+        }
+    }
+    // x меняется на каждой итерации, иначе с -O выражение свернулось бы в константу
+    return "s = 0;\ni = 100;\nwhile (i > 0) {\nx = i / 10 + 1;\ns = " + expression + ";\ni = i - 1;\n};\nprint(s);\n";
+}
+
+// Счётный цикл на 20000 * scale итераций, в теле 64 переменные зависят друг от друга
+string manyVariablesProgram(int scale)
+{
+    const int variables = 64;
+    string text;
+    for (int k = 0; k < variables; ++k)
+        text += "v" + to_string(k) + " = " + to_string(k) + ";\n";
+    text += "i = " + to_string(20000 * scale) + ";\nwhile (i > 0) {\n";
+    for (int k = 0; k < variables; ++k)
+        text += "v" + to_string(k) + " = v" + to_string(k) + " / 2 + v" + to_string((k + 1) % variables) + " / 3 + 1;\n";
+    text += "i = i - 1;\n};\n";
+    for (int k = 0; k < variables; k += 8)
+        text += "print(v" + to_string(k) + ");\n";
+    return text;
+}
+
+// 20000 * scale присваиваний подряд без циклов: лексер и парсер на большом файле, таблица меток пуста.
+// С -O распространение констант сворачивает всю программу, и этап run почти пуст.
+string flatListProgram(int scale)
+{
+    const int variables = 500;
+    int statements = 20000 * scale;
+    string text;
+    for (int k = 0; k < variables; ++k)
+        text += "a" + to_string(k) + " = " + to_string(k) + ";\n";
+    for (int k = 0; k < statements; ++k)
+        text += "a" + to_string(k % variables) + " = a" + to_string((k * 7 + 1) % variables) + " / 2 + " + to_string(k % 100) + ";\n";
+    for (int k = 0; k < variables; k += 50)
+        text += "print(a" + to_string(k) + ");\n";
+    return text;
+}
+
+// Цикл на 200000 * scale итераций с вещественными умножением, делением и сравнением
+string floatMathProgram(int scale)
+{
+    return "f = 0.5;\ng = 1.25;\nh = 0.0;\ni = " + to_string(200000 * scale) +
+           ";\nwhile (i > 0) {\n"
+           "f = f * 1.000001 + g / 3.5;\n"
+           "g = g * 0.999 + 0.001;\n"
+           "if (f > 100.0) { f = f / 7.25; } else { h = h + 0.5 * g; };\n"
+           "i = i - 1;\n};\nprint(f);\nprint(g);\nprint(h);\n";
+}
+
+struct Workload
+{
+    string name;
+    function<string(int)> generate;
+};
+
+const vector<Workload> workloads = {
+    {"nested-if", nestedIfProgram},
+    {"long-expression", longExpressionProgram},
+    {"many-variables", manyVariablesProgram},
+    {"flat-list", flatListProgram},
+    {"float-math", floatMathProgram},
+};
+
+// --- ЗАМЕРЫ ---
+// Печать программы замеру не нужна: считается и выбрасывается
+class DiscardIO : public RuntimeIO
+{
+public:
+    size_t printed = 0;
+    ReadStatus read(const string &, variant<int, float, string> &, string &error) override
+    {
+        error = "Runtime Error: benchmark programs do not read.";
+        return ReadStatus::Failed;
+    }
+    void print(const string &, const variant<int, float, string> &) override { ++printed; }
+};
+
+struct Measurement
+{
+    string workload;
+    string stage;
+    size_t bytes;  // Размер исходника
+    size_t items;  // Что обработано за один прогон: лексемы, элементы ОПС или инструкции
+    string unit;
+    double min_ms;
+    double median_ms;
+};
+
+// Время одного прогона body в миллисекундах: repeat прогонов после одного прогревочного
+vector<double> timeRuns(int repeat, const function<void()> &body)
+{
+    body();
+    vector<double> times;
+    for (int r = 0; r < repeat; ++r)
+    {
+        auto start = chrono::steady_clock::now();
+        body();
+        times.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+    sort(times.begin(), times.end());
+    return times;
+}
+
+// Лексер и парсер ждут текст в том же виде, что даёт convert(): строки с '\n' и завершающий '\0'
+string lexerText(const string &source)
+{
+    return source + '\0';
+}
+
+bool measureWorkload(const Workload &workload, int scale, int repeat, bool optimize, unsigned compile_threads,
+                     vector<Measurement> &results)
+{
+    string source = workload.generate(scale);
+    string text = lexerText(source);
+    ostream null_out(nullptr); // Сообщения парсера и оптимизатора не печатаются
+    auto add = [&](const string &stage, size_t items, const string &unit, const vector<double> &times)
+    { results.push_back({workload.name, stage, source.size(), items, unit, times.front(), times[times.size() / 2]}); };
+
+    size_t tokens = 0;
+    add("lex", 0, "tokens", timeRuns(repeat, [&]()
+                                      {
+                                          Lexer lexer(text);
+                                          tokens = 0;
+                                          while (lexer.getNextToken().type != TOKEN_EOF)
+                                              ++tokens;
+                                      }));
+    results.back().items = tokens;
+
+    vector<OPSElement> ops_code;
+    bool parsed = false;
+    add("parse", 0, "ops", timeRuns(repeat, [&]()
+                                     {
+                                         Lexer lexer(text);
+                                         ops_code.clear();
+                                         Parser parser(lexer, ops_code, null_out, null_out);
+                                         parser.parse();
+                                         parsed = !parser.hasSyntaxError() && !parser.hasSemanticErrors();
+                                     }));
+    results.back().items = ops_code.size();
+    if (!parsed)
+    {
+        cerr << workload.name << ": generated program does not compile" << endl;
+        return false;
+    }
+
+    if (compile_threads > 0)
+    {
+        vector<OPSElement> chunked;
+        add("pparse", 0, "ops", timeRuns(repeat, [&]()
+                                          {
+                                              chunked.clear();
+                                              parseParallel(text, chunked, nullptr, compile_threads, null_out, null_out);
+                                          }));
+        results.back().items = chunked.size();
+        if (programHash(chunked) != programHash(ops_code))
+        {
+            cerr << workload.name << ": parallel parse produced different OPS" << endl;
+            return false;
+        }
+    }
+
+    // Правка и обратная правка по очереди; первая сборка - до замера
+    size_t digit = text.find_first_of("0123456789", text.size() / 2);
+    if (digit != string::npos)
+    {
+        string edited = text;
+        edited[digit] = edited[digit] == '1' ? '2' : '1';
+        IncrementalCompiler compiler;
+        bool compiled = compiler.compile(text, null_out, null_out);
+        bool flip = false;
+        add("edit", 0, "statements", timeRuns(repeat, [&]()
+                                              {
+                                                  flip = !flip;
+                                                  compiled = compiler.compile(flip ? edited : text, null_out, null_out) && compiled;
+                                              }));
+        results.back().items = compiler.parsedStatements();
+        if (!compiled)
+        {
+            cerr << workload.name << ": incremental recompilation failed" << endl;
+            return false;
+        }
+    }
+
+    if (optimize)
+    {
+        OptimizerOptions options;
+        options.out = options.err = &null_out;
+        vector<OPSElement> optimized;
+        add("opt", ops_code.size(), "ops", timeRuns(repeat, [&]()
+                                                     {
+                                                         optimized = ops_code;
+                                                         optimizeOPS(optimized, options);
+                                                     }));
+        ops_code = optimized;
+    }
+
+    Interpreter inter(ops_code);
+    DiscardIO io;
+    bool ran = true;
+    add("run", 0, "instructions", timeRuns(repeat, [&]() { ran = inter.run(io) && ran; }));
+    results.back().items = inter.instructions();
+    if (!ran)
+    {
+        cerr << workload.name << ": " << inter.error() << endl;
+        return false;
+    }
+    return true;
+}
+
+// Элементов в секунду по минимальному времени
+double throughput(const Measurement &m)
+{
+    return m.min_ms > 0 ? static_cast<double>(m.items) / (m.min_ms / 1000.0) : 0.0;
+}
+
+void writeText(ostream &out, const vector<Measurement> &results)
+{
+    out << left << setw(17) << "workload" << setw(7) << "stage" << right << setw(10) << "bytes" << setw(12) << "items"
+        << setw(12) << "min ms" << setw(12) << "median ms" << setw(16) << "items/s" << "\n";
+    for (const Measurement &m : results)
+        out << left << setw(17) << m.workload << setw(7) << m.stage << right << setw(10) << m.bytes << setw(12) << m.items
+            << fixed << setprecision(3) << setw(12) << m.min_ms << setw(12) << m.median_ms << setprecision(0) << setw(16)
+            << throughput(m) << " " << m.unit << "/s\n";
+}
+
+// Поля и строки всегда в одном порядке: файлы разных версий сравниваются построчно и bench/compare.py
+void writeJson(ostream &out, int scale, int repeat, bool optimize, const vector<Measurement> &results)
+{
+    out << "{\n  \"schema\": 1,\n  \"scale\": " << scale << ",\n  \"repeat\": " << repeat
+        << ",\n  \"optimize\": " << (optimize ? "true" : "false") << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Measurement &m = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"workload\": \"" << m.workload << "\", \"stage\": \"" << m.stage
+            << "\", \"bytes\": " << m.bytes << ", \"items\": " << m.items << ", \"unit\": \"" << m.unit << "\", \"min_ms\": "
+            << fixed << setprecision(3) << m.min_ms << ", \"median_ms\": " << m.median_ms << ", \"per_second\": "
+            << setprecision(0) << throughput(m) << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char *argv[])
+{
+    int scale = 1, repeat = 5;
+    bool optimize = false;
+    unsigned compile_threads = 0;
+    string filter, json_file, emit_dir;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.compare(0, 8, "--scale=") == 0)
+            scale = max(1, atoi(arg.c_str() + 8));
+        else if (arg.compare(0, 9, "--repeat=") == 0)
+            repeat = max(1, atoi(arg.c_str() + 9));
+        else if (arg.compare(0, 9, "--filter=") == 0)
+            filter = arg.substr(9);
+        else if (arg == "-O")
+            optimize = true;
+        else if (arg.compare(0, 18, "--compile-threads=") == 0)
+            compile_threads = static_cast<unsigned>(max(0, atoi(arg.c_str() + 18)));
+        else if (arg.compare(0, 7, "--json=") == 0)
+            json_file = arg.substr(7);
+        else if (arg.compare(0, 7, "--emit=") == 0)
+            emit_dir = arg.substr(7);
+        else
+        {
+            cerr << "usage: translator-bench [--scale=N] [--repeat=N] [--filter=NAME] [-O] [--compile-threads=N] [--json=FILE] [--emit=DIR]" << endl;
+            return 1;
+        }
+    }
+
+    if (!emit_dir.empty())
+    {
+        for (const Workload &workload : workloads)
+            if (workload.name.find(filter) != string::npos)
+            {
+                string path = emit_dir + "/" + workload.name + ".txt";
+                ofstream file(path, ios::binary);
+                file << workload.generate(scale);
+                if (!file)
+                {
+                    cerr << "Cannot write " << path << endl;
+                    return 1;
+                }
+            }
+        return 0;
+    }
+
+    vector<Measurement> results;
+    bool ok = true;
+    for (const Workload &workload : workloads)
+        if (workload.name.find(filter) != string::npos)
+            ok = measureWorkload(workload, scale, repeat, optimize, compile_threads, results) && ok;
+    writeText(cout, results);
+    if (!json_file.empty())
+    {
+        ofstream json(json_file);
+        writeJson(json, scale, repeat, optimize, results);
+        if (!json)
+        {
+            cerr << "Cannot write " << json_file << endl;
+            return 1;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# Сравнение двух результатов translator-bench --json: время каждой пары (нагрузка, этап) по минимальному времени.
+# Замедление больше порога помечается REGRESSION, и код выхода 1 - так сравнение можно ставить в CI.
+# Если число обработанных элементов изменилось (другой генератор, другой вывод парсера), строка помечается "items":
+# время такой пары сравнивать нельзя.
+#
+# Запуск: python3 bench/compare.py old.json new.json [--threshold=10]
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    if data.get("schema") != 1:
+        raise SystemExit("%s: unknown schema %r" % (path, data.get("schema")))
+    return data, {(r["workload"], r["stage"]): r for r in data["results"]}
+
+
+def main():
+    args = [a for a in sys.argv[1:] if not a.startswith("--")]
+    flags = dict(a[2:].split("=", 1) for a in sys.argv[1:] if a.startswith("--") and "=" in a)
+    if len(args) != 2:
+        print("usage: compare.py <old.json> <new.json> [--threshold=PERCENT]")
+        return 2
+    threshold = float(flags.get("threshold", 10))
+    old_data, old = load(args[0])
+    new_data, new = load(args[1])
+    for key in ("scale", "optimize"):
+        if old_data.get(key) != new_data.get(key):
+            print("warning: %s differs (%r vs %r)" % (key, old_data.get(key), new_data.get(key)))
+
+    regressions = 0
+    print("%-17s%-7s%12s%12s%10s" % ("workload", "stage", "old ms", "new ms", "change"))
+    for key in sorted(set(old) | set(new)):
+        if key not in old or key not in new:
+            print("%-17s%-7s%s" % (key[0], key[1], "   only in " + ("new" if key in new else "old")))
+            continue
+        a, b = old[key], new[key]
+        change = (b["min_ms"] / a["min_ms"] - 1) * 100 if a["min_ms"] > 0 else 0.0
+        note = ""
+        if a["items"] != b["items"]:
+            note = "  items %d -> %d" % (a["items"], b["items"])
+        elif change > threshold:
+            note = "  REGRESSION"
+            regressions += 1
+        elif change < -threshold:
+            note = "  faster"
+        print("%-17s%-7s%12.3f%12.3f%+9.1f%%%s" % (key[0], key[1], a["min_ms"], b["min_ms"], change, note))
+    if regressions:
+        print("%d regression(s) above %.1f%%" % (regressions, threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# Накладные расходы --max-instructions / --max-time на программах из циклов: каждая программа выполняется
+# без ограничений и с ограничениями, которые не срабатывают (проверки есть, остановки нет).
+# Ограничения проверяются только на переходах назад и read/print, поэтому разница должна быть в пределах шума.
+#
+# Запуск: python3 bench/limits_overhead.py build/interpreter [--repeat=N] [-O]
+import os
+import resource
+import subprocess
+import sys
+import tempfile
+
+PROGRAMS = {
+    # Короткое тело: переход назад почти на каждой второй инструкции - худший случай для проверок
+    "tight-loop": "x = 2000000;\nwhile (x > 0) { x = x - 1; };\nprint(x);\n",
+    "sum-loop": "x = 1000000;\ns = 0;\nwhile (x > 0) { s = s + x * 3 - x / 2; x = x - 1; };\nprint(s);\n",
+    "nested": "i = 1000;\nt = 0;\nwhile (i > 0) { j = 1000; while (j > 0) { t = t + 1; j = j - 1; }; i = i - 1; };\nprint(t);\n",
+    "float-loop": "x = 1000000;\nf = 0.5;\nwhile (x > 0) { f = f * 1.000001 + 0.25; x = x - 1; };\nprint(f);\n",
+    "print-loop": "x = 300000;\nwhile (x > 0) { print(x); x = x - 1; };\n",
+}
+
+CONFIGS = [
+    ("off", []),
+    ("fuel", ["--max-instructions=1000000000000"]),
+    ("time", ["--max-time=3600000"]),
+    ("both", ["--max-instructions=1000000000000", "--max-time=3600000"]),
+]
+
+
+def cpu_time(command):
+    # Процессорное время дочернего процесса: меньше шума, чем у настенного времени
+    before = resource.getrusage(resource.RUSAGE_CHILDREN)
+    result = subprocess.run(command, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    after = resource.getrusage(resource.RUSAGE_CHILDREN)
+    if result.returncode != 0 or result.stderr:
+        raise SystemExit("failed: %s\n%s" % (" ".join(command), result.stderr.decode(errors="replace")))
+    return (after.ru_utime - before.ru_utime) + (after.ru_stime - before.ru_stime)
+
+
+def best_times(commands, repeat):
+    # Конфигурации чередуются в каждом повторе, чтобы дрейф частоты и фоновой нагрузки делился между ними поровну
+    best = [None] * len(commands)
+    for _ in range(repeat):
+        for k, command in enumerate(commands):
+            elapsed = cpu_time(command)
+            best[k] = elapsed if best[k] is None else min(best[k], elapsed)
+    return best
+
+
+def main():
+    args = [a for a in sys.argv[1:] if not a.startswith("-")]
+    flags = dict(a[2:].split("=", 1) for a in sys.argv[1:] if a.startswith("--") and "=" in a)
+    if not args:
+        print("usage: limits_overhead.py <interpreter> [--repeat=N] [-O]")
+        return 1
+    interpreter = args[0]
+    repeat = int(flags.get("repeat", 5))
+    extra = ["-O"] if "-O" in sys.argv[1:] else []
+
+    print("%-11s" % "program" + "".join("%10s" % name for name, _ in CONFIGS) + "   overhead (min CPU time, s)")
+    with tempfile.TemporaryDirectory() as directory:
+        for name, text in PROGRAMS.items():
+            path = os.path.join(directory, name + ".txt")
+            with open(path, "w") as source:
+                source.write(text)
+            times = best_times([[interpreter, "--batch"] + extra + config + [path] for _, config in CONFIGS], repeat)
+            overheads = " ".join("%+.1f%%" % ((t / times[0] - 1) * 100) for t in times[1:])
+            print("%-11s" % name + "".join("%10.3f" % t for t in times) + "   " + overheads)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+# Сборка interpreter по профилю (PGO + LTO) и отчёт об ускорении относительно обычной сборки -O2:
+#   1. plain    - CMAKE_CXX_FLAGS_RELEASE="-O2 -DNDEBUG", без PGO и LTO; заодно собирается translator-bench
+#   2. pgo      - та же -O2 с TRANSLATOR_PGO=GENERATE и TRANSLATOR_LTO=ON, тренировка на корпусе
+#   3. pgo      - тот же каталог с TRANSLATOR_PGO=USE: итоговая программа WORK/pgo/interpreter
+#   4. обе программы выполняют программы замера поочерёдно, в отчёт идёт минимальное процессорное время
+# Корпус тренировки - translator-bench --emit (--scale=1), test.txt и *.txt из --corpus=DIR; каждая программа
+# выполняется без -O и с -O. Если рядом с программой есть NAME.in, он идёт в read() через --input.
+# Замер - на тех же нагрузках в размере --measure-scale (по умолчанию 2), а не на тех, что видел профиль.
+#
+# Запуск: python3 bench/pgo.py [--work=DIR] [--corpus=DIR] [--measure-scale=N] [--repeat=N]
+import glob
+import math
+import os
+import resource
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PLAIN_FLAGS = "-O2 -DNDEBUG"
+
+
+def run(command, **kwargs):
+    print("+ " + " ".join(command), flush=True)
+    subprocess.run(command, check=True, **kwargs)
+
+
+def configure_and_build(build_dir, targets, options):
+    run(["cmake", "-S", ROOT, "-B", build_dir, "-DCMAKE_BUILD_TYPE=Release", "-DCMAKE_CXX_FLAGS_RELEASE=" + PLAIN_FLAGS] +
+        ["-D%s=%s" % item for item in options.items()], stdout=subprocess.DEVNULL)
+    run(["cmake", "--build", build_dir, "-j%d" % os.cpu_count(), "--target"] + targets, stdout=subprocess.DEVNULL)
+
+
+def program_command(interpreter, program, flags):
+    command = [interpreter, program] + flags
+    input_file = os.path.splitext(program)[0] + ".in"
+    if os.path.exists(input_file):
+        command.append("--input=" + input_file)
+    return command
+
+
+def cpu_time(command):
+    # Процессорное время дочернего процесса: меньше шума, чем у настенного времени
+    before = resource.getrusage(resource.RUSAGE_CHILDREN)
+    subprocess.run(command, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    after = resource.getrusage(resource.RUSAGE_CHILDREN)
+    return (after.ru_utime - before.ru_utime) + (after.ru_stime - before.ru_stime)
+
+
+def main():
+    flags = dict(a[2:].split("=", 1) for a in sys.argv[1:] if a.startswith("--") and "=" in a)
+    work = os.path.abspath(flags.get("work", os.path.join(ROOT, "build-pgo")))
+    measure_scale = int(flags.get("measure-scale", 2))
+    repeat = int(flags.get("repeat", 5))
+    plain_dir = os.path.join(work, "plain")
+    pgo_dir = os.path.join(work, "pgo")
+    profile_dir = os.path.join(work, "profile")
+    train_dir = os.path.join(work, "train")
+    measure_dir = os.path.join(work, "measure")
+
+    # 1. Обычная сборка и корпуса
+    configure_and_build(plain_dir, ["interpreter", "translator-bench"], {"TRANSLATOR_PGO": "OFF", "TRANSLATOR_LTO": "OFF"})
+    bench = os.path.join(plain_dir, "translator-bench")
+    for directory in (train_dir, measure_dir):
+        shutil.rmtree(directory, ignore_errors=True)
+        os.makedirs(directory)
+    run([bench, "--scale=1", "--emit=" + train_dir])
+    run([bench, "--scale=%d" % measure_scale, "--emit=" + measure_dir])
+    shutil.copy(os.path.join(ROOT, "test.txt"), train_dir)
+    with open(os.path.join(train_dir, "test.in"), "w") as f:
+        f.write("10\n")
+    training = sorted(glob.glob(os.path.join(train_dir, "*.txt")))
+    if "corpus" in flags:
+        training += sorted(glob.glob(os.path.join(flags["corpus"], "*.txt")))
+
+    # 2. Инструментированная сборка и тренировка; старый профиль удаляется, иначе счётчики сложатся
+    shutil.rmtree(profile_dir, ignore_errors=True)
+    pgo_options = {"TRANSLATOR_PGO": "GENERATE", "TRANSLATOR_LTO": "ON", "TRANSLATOR_PGO_DIR": profile_dir}
+    configure_and_build(pgo_dir, ["interpreter"], pgo_options)
+    interpreter = os.path.join(pgo_dir, "interpreter")
+    for program in training:
+        for mode in ([], ["-O"]):
+            command = program_command(interpreter, program, mode)
+            print("+ " + " ".join(command), flush=True)
+            subprocess.run(command, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+    # 3. Сборка по профилю в том же каталоге
+    raw = glob.glob(os.path.join(profile_dir, "*.profraw"))  # Clang; GCC пишет .gcda, которые читает сам
+    if raw:
+        run(["llvm-profdata", "merge", "-o", os.path.join(profile_dir, "default.profdata")] + raw)
+    pgo_options["TRANSLATOR_PGO"] = "USE"
+    configure_and_build(pgo_dir, ["interpreter"], pgo_options)
+
+    # 4. Замер: сборки чередуются в каждом повторе, чтобы дрейф частоты делился поровну
+    plain = os.path.join(plain_dir, "interpreter")
+    rows = []
+    for program in sorted(glob.glob(os.path.join(measure_dir, "*.txt"))):
+        for mode in ([], ["-O"]):
+            best = [None, None]
+            for _ in range(repeat):
+                for k, binary in enumerate((plain, interpreter)):
+                    elapsed = cpu_time(program_command(binary, program, mode))
+                    best[k] = elapsed if best[k] is None else min(best[k], elapsed)
+            name = os.path.splitext(os.path.basename(program))[0] + (" -O" if mode else "")
+            rows.append((name, best[0], best[1]))
+
+    report = ["%-20s%12s%12s%10s" % ("program", "-O2 s", "PGO+LTO s", "speedup")]
+    for name, plain_time, pgo_time in rows:
+        report.append("%-20s%12.3f%12.3f%9.2fx" % (name, plain_time, pgo_time, plain_time / pgo_time))
+    geomean = math.exp(sum(math.log(p / q) for _, p, q in rows) / len(rows))
+    report.append("geometric mean speedup: %.2fx (min CPU time of %d runs, measure scale %d)" % (geomean, repeat, measure_scale))
+    with open(os.path.join(work, "report.txt"), "w") as f:
+        f.write("\n".join(report) + "\n")
+    print("\n".join(report))
+    print("optimized interpreter: " + interpreter)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
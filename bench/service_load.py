@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+# Нагрузка на translator-service: параллельные клиенты шлют короткие программы вперемешку с длинными
+# и меряют пропускную способность (программ в секунду) и задержки ответа (p50/p90/p99/max).
+# Длинные программы - это счётный while на --long-iterations итераций: без отрезков (--slice=0 у сервиса)
+# они занимают потоки целиком, и задержка коротких программ растёт до времени длинной.
+#
+# Запуск: translator-service --socket=/tmp/translator.sock &
+#         python3 bench/service_load.py /tmp/translator.sock [--clients=N] [--requests=N] [--long-every=N]
+import socket
+import sys
+import threading
+import time
+
+SHORT = """x = 200;
+s = 0;
+while (x > 0) { s = s + x * 3; x = x - 1; };
+print(s);
+read(a);
+print(a + 1);
+%%
+41
+"""
+
+
+def long_program(iterations):
+    return "x = %d;\ns = 0;\nwhile (x > 0) { s = s + x; x = x - 1; };\nprint(s);\n" % iterations
+
+
+def request(path, text):
+    start = time.perf_counter()
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conn:
+        conn.connect(path)
+        conn.sendall(text.encode())
+        conn.shutdown(socket.SHUT_WR)
+        chunks = []
+        while True:
+            chunk = conn.recv(65536)
+            if not chunk:
+                break
+            chunks.append(chunk)
+    return time.perf_counter() - start, b"".join(chunks).decode(errors="replace")
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p / 100.0 * len(values)))]
+
+
+def main():
+    args = [a for a in sys.argv[1:] if not a.startswith("--")]
+    flags = dict(a[2:].split("=", 1) for a in sys.argv[1:] if a.startswith("--") and "=" in a)
+    if not args:
+        print("usage: service_load.py <socket> [--clients=N] [--requests=N] [--long-every=N] [--long-iterations=N]")
+        return 1
+    path = args[0]
+    clients = int(flags.get("clients", 16))
+    requests = int(flags.get("requests", 2000))
+    long_every = int(flags.get("long-every", 50))  # Каждая N-я программа длинная, 0 - только короткие
+    long_text = long_program(int(flags.get("long-iterations", 2000000)))
+
+    latencies = {"short": [], "long": []}
+    failures = []
+    lock = threading.Lock()
+    counter = iter(range(requests))
+
+    def client():
+        while True:
+            with lock:
+                number = next(counter, None)
+            if number is None:
+                return
+            kind = "long" if long_every and number % long_every == 0 else "short"
+            elapsed, response = request(path, long_text if kind == "long" else SHORT)
+            with lock:
+                latencies[kind].append(elapsed)
+                if not response.startswith("status: ok"):
+                    failures.append(response.splitlines()[0] if response else "no response")
+
+    start = time.perf_counter()
+    threads = [threading.Thread(target=client) for _ in range(clients)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    wall = time.perf_counter() - start
+
+    print("requests: %d, clients: %d, wall: %.2fs, throughput: %.1f programs/s"
+          % (requests, clients, wall, requests / wall))
+    print("%-6s %7s %9s %9s %9s %9s" % ("kind", "count", "p50 ms", "p90 ms", "p99 ms", "max ms"))
+    for kind in ("short", "long"):
+        values = latencies[kind]
+        print("%-6s %7d %9.2f %9.2f %9.2f %9.2f" % (kind, len(values), percentile(values, 50) * 1000,
+                                                    percentile(values, 90) * 1000, percentile(values, 99) * 1000,
+                                                    max(values or [0]) * 1000))
+    if failures:
+        print("failed: %d (first: %s)" % (len(failures), failures[0]))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
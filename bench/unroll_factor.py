@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+# Замер: как фактор разворачивания циклов (--unroll=N) влияет на время счётного цикла
+# с телом разного размера. По результатам выбран default_unroll_factor в optimizer.cpp.
+#
+# Запуск: python3 bench/unroll_factor.py ./interpreter [итераций] [повторов]
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+FACTORS = [1, 2, 4, 8]
+BODY_SIZES = [1, 2, 4, 8, 16]
+
+
+def program(body_size, iterations):
+    # Тело: body_size присваиваний плюс шаг счётчика, как в "while (x > 0) { s = s + x; x = x - 1; }"
+    lines = ["x = %d;" % iterations]
+    for k in range(body_size):
+        lines.append("s%d = 0;" % k)
+    lines.append("while (x > 0) {")
+    for k in range(body_size):
+        lines.append("  s%d = s%d + x * %d;" % (k, k, k + 1))
+    lines.append("  x = x - 1;")
+    lines.append("};")
+    for k in range(body_size):
+        lines.append("print(s%d);" % k)  # Иначе суммы уберёт удаление мёртвого кода
+    return "\n".join(lines) + "\n"
+
+
+def measure(interpreter, path, factor, repeats):
+    best = None
+    for _ in range(repeats):
+        start = time.perf_counter()
+        subprocess.run([interpreter, path, "-O", "--unroll=%d" % factor],
+                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: unroll_factor.py <interpreter> [iterations] [repeats]")
+        return 1
+    interpreter = sys.argv[1]
+    iterations = int(sys.argv[2]) if len(sys.argv) > 2 else 200000
+    repeats = int(sys.argv[3]) if len(sys.argv) > 3 else 3
+
+    print("iterations: %d, best of %d runs, time relative to --unroll=1" % (iterations, repeats))
+    print("%-6s" % "body" + "".join("%12s" % ("x%d" % f) for f in FACTORS) + "%8s" % "best")
+    with tempfile.TemporaryDirectory() as tmp:
+        for size in BODY_SIZES:
+            path = os.path.join(tmp, "body%d.txt" % size)
+            with open(path, "w") as f:
+                f.write(program(size, iterations))
+            times = [measure(interpreter, path, factor, repeats) for factor in FACTORS]
+            best = FACTORS[times.index(min(times))]
+            print("%-6d" % size + "".join("%12s" % ("%.3fs %.2f" % (t, t / times[0])) for t in times)
+                  + "%8s" % ("x%d" % best))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
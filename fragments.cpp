@@ -0,0 +1,447 @@
+#include "fragments.h"
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <cstring> // Для memcmp
+
+namespace translator::detail
+{
+// Операторы верхнего уровня по порядку, начиная с at (глубина скобок там нулевая): каждый кончается сразу после своего ';',
+// хвост без ';' - последний. Лексер останавливается на '\0' (и на символе EOF), поэтому за ним операторов нет.
+struct StatementCursor
+{
+    const string &text;
+    SourceSpan at; // Начало следующего оператора, end не используется
+
+    // Следующий оператор, объединённый с соседними в кусок не короче min_size байт; false - текст кончился
+    bool next(SourceSpan &statement, size_t min_size = 0)
+    {
+        size_t row = at.row, column = at.column;
+        long depth = 0; // Лишняя '}' уводит в минус: там разбор остановится, и операторы за ней не понадобятся
+        size_t i = at.begin;
+        for (; i < text.size() && text[i] != '\0' && text[i] != EOF; ++i)
+        {
+            char c = text[i];
+            if (c == '\n')
+            {
+                ++row;
+                column = 0;
+            }
+            else
+                ++column;
+            if (c == '{')
+                ++depth;
+            else if (c == '}')
+                --depth;
+            else if (c == ';' && depth == 0 && i + 1 - at.begin >= min_size)
+            {
+                statement = SourceSpan{at.begin, i + 1, at.row, at.column};
+                at = SourceSpan{i + 1, 0, row, column};
+                return true;
+            }
+        }
+        if (at.begin == i)
+            return false;
+        statement = SourceSpan{at.begin, i, at.row, at.column};
+        at = SourceSpan{i, 0, row, column};
+        return true;
+    }
+};
+
+// Весь текст кусками не короче min_size байт
+vector<SourceSpan> splitStatements(const string &text, size_t min_size = 0)
+{
+    vector<SourceSpan> spans;
+    StatementCursor cursor{text, SourceSpan{0, 0, 0, 0}};
+    SourceSpan span;
+    while (cursor.next(span, min_size))
+        spans.push_back(span);
+    return spans;
+}
+
+void parseFragment(const string &text, const SourceSpan &span, Fragment &fragment, bool with_positions)
+{
+    ostringstream messages;
+    try
+    {
+        Lexer lexer(text.substr(span.begin, span.end - span.begin), span.row, span.column);
+        Parser parser(lexer, fragment.ops, messages, messages, with_positions ? &fragment.positions : nullptr);
+        parser.deferUndefinedVariables(&fragment.unresolved);
+        if (span.begin != 0)
+            parser.continueAfter(SourcePosition{span.row + 1, span.column}); // ';' перед куском, столбец с единицы
+        while (parser.parseStatement())
+            ;
+        fragment.syntax_error = parser.hasSyntaxError();
+        fragment.reached_end = parser.atEnd();
+        fragment.labels = parser.labelCount();
+        const unordered_set<string> &defined = parser.definedVariables();
+        fragment.defined.assign(defined.begin(), defined.end());
+    }
+    catch (const runtime_error &e)
+    {
+        fragment.lexical_error = e.what();
+    }
+    fragment.messages = messages.str();
+}
+
+// "L3" и "L3:" с base == 10 становятся "L13" и "L13:"
+void relocateLabel(OPSElement &element, size_t base)
+{
+    string &name = get<string>(element.value);
+    bool definition = name.back() == ':';
+    size_t number = strtoull(name.c_str() + 1, nullptr, 10) + base;
+    name = "L" + to_string(number) + (definition ? ":" : "");
+}
+
+// Место куска в склеенной программе
+struct FragmentPlace
+{
+    size_t label_base; // Номер, который получает метка L0 куска
+    size_t offset;     // Индекс первого элемента ОПС куска
+};
+
+// Итог разбора в out и err, как в конце Parser::parse()
+void reportParseResult(ostream &out, ostream &err, bool syntax_error, bool semantic_error)
+{
+    if (syntax_error)
+        err << "Parsing failed: Syntax errors found." << endl;
+    else
+    {
+        out << "Parsing successful: Syntax is correct." << endl;
+        if (semantic_error)
+            err << "Semantic analysis failed: variables used before definition." << endl;
+    }
+}
+
+// Склейка, часть 1 - по порядку: сообщения, как у Parser::parse(), в out и err, и места кусков, входящих в программу
+// (разбор кончается на синтаксической ошибке или на лексеме, которая не начинает оператор). Исключение лексера
+// бросается заново, как из parse(). total - элементов ОПС во входящих кусках.
+// false - синтаксическая ошибка или переменная без значения.
+bool planFragments(const vector<Fragment> &fragments, vector<FragmentPlace> &places, size_t &total, ostream &out, ostream &err)
+{
+    unordered_set<string> defined;
+    size_t label_base = 0;
+    bool syntax_error = false, semantic_error = false;
+    places.clear();
+    total = 0;
+    for (const Fragment &fragment : fragments)
+    {
+        for (const VariableUse &use : fragment.unresolved)
+            if (!defined.count(use.name))
+            {
+                reportUndefinedVariable(err, use);
+                semantic_error = true;
+            }
+        if (!fragment.lexical_error.empty())
+            throw runtime_error(fragment.lexical_error);
+        err << fragment.messages;
+        places.push_back(FragmentPlace{label_base, total});
+        total += fragment.ops.size();
+        if (fragment.syntax_error)
+        {
+            syntax_error = true;
+            break;
+        }
+        if (!fragment.reached_end)
+            break; // Как и StatementList, разбор кончается на первой лексеме, которая не начинает оператор
+        defined.insert(fragment.defined.begin(), fragment.defined.end());
+        label_base += fragment.labels;
+    }
+    reportParseResult(out, err, syntax_error, semantic_error);
+    return !syntax_error && !semantic_error;
+}
+
+// Часть 2: ОПС куска с перенумерованными метками переносится на своё место в ops_code (и positions), размер которых
+// уже выставлен. Куски не пересекаются, поэтому их можно переносить параллельно.
+void placeFragment(Fragment &fragment, const FragmentPlace &place, vector<OPSElement> &ops_code, vector<SourcePosition> *positions)
+{
+    for (size_t i = 0; i < fragment.ops.size(); ++i)
+    {
+        OPSElement &element = fragment.ops[i];
+        if (element.code == OPSCode::OP_LABEL && place.label_base != 0)
+            relocateLabel(element, place.label_base);
+        ops_code[place.offset + i] = move(element);
+    }
+    if (positions && !fragment.positions.empty())
+        copy(fragment.positions.begin(), fragment.positions.end(), positions->begin() + static_cast<ptrdiff_t>(place.offset));
+    vector<OPSElement>().swap(fragment.ops);
+}
+
+// Задачи 0 .. count - 1 на threads потоках, текущий - один из них
+void runParallel(unsigned threads, size_t count, const function<void(size_t)> &task)
+{
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (size_t i; (i = next.fetch_add(1)) < count;)
+            task(i);
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads && t < count; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (thread &t : pool)
+        t.join();
+}
+
+bool parseParallel(const string &text, vector<OPSElement> &ops_code, vector<SourcePosition> *positions, unsigned threads,
+                   ostream &out, ostream &err)
+{
+    // Кусков в несколько раз больше, чем потоков: операторы бывают разной длины, и освободившийся поток берёт следующий
+    vector<SourceSpan> chunks = splitStatements(text, text.size() / (static_cast<size_t>(threads) * 8));
+    if (chunks.empty())
+        chunks.push_back(SourceSpan{0, 0, 0, 0}); // Пустая программа
+    vector<Fragment> fragments(chunks.size());
+    runParallel(threads, chunks.size(), [&](size_t i) { parseFragment(text, chunks[i], fragments[i], positions != nullptr); });
+
+    vector<FragmentPlace> places;
+    size_t total;
+    bool ok = planFragments(fragments, places, total, out, err);
+    ops_code.assign(total, OPSElement(OPSCode::OP_ERROR));
+    if (positions)
+        positions->assign(total, SourcePosition{});
+    runParallel(threads, places.size(), [&](size_t i) { placeFragment(fragments[i], places[i], ops_code, positions); });
+    return ok;
+}
+
+size_t IncrementalCompiler::commonPrefix(const char *a, const char *b, size_t limit)
+{
+    const size_t block = 4096;
+    size_t i = 0;
+    while (i + block <= limit && memcmp(a + i, b + i, block) == 0)
+        i += block;
+    while (i < limit && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+size_t IncrementalCompiler::commonSuffix(const char *a_end, const char *b_end, size_t limit)
+{
+    const size_t block = 4096;
+    size_t i = 0;
+    while (i + block <= limit && memcmp(a_end - i - block, b_end - i - block, block) == 0)
+        i += block;
+    while (i < limit && *(a_end - i - 1) == *(b_end - i - 1))
+        ++i;
+    return i;
+}
+
+template <class T>
+void IncrementalCompiler::splice(vector<T> &items, size_t from, size_t removed, vector<T> &added)
+{
+    size_t common = min(removed, added.size());
+    move(added.begin(), added.begin() + static_cast<ptrdiff_t>(common), items.begin() + static_cast<ptrdiff_t>(from));
+    auto at = items.begin() + static_cast<ptrdiff_t>(from + common);
+    if (added.size() > removed)
+    {
+        size_t needed = items.size() + added.size() - removed;
+        if (needed > items.capacity())
+            items.reserve(needed + needed / 8); // Запас, чтобы следующие правки не перекладывали всё заново
+        at = items.begin() + static_cast<ptrdiff_t>(from + common);
+        items.insert(at, make_move_iterator(added.begin() + static_cast<ptrdiff_t>(common)), make_move_iterator(added.end()));
+    }
+    else
+        items.erase(at, at + static_cast<ptrdiff_t>(removed - common));
+}
+
+void IncrementalCompiler::link(Statement *statement, bool add, unordered_set<string> &touched)
+{
+    auto update = [&](StatementSet VariableLinks::*which, const string &name)
+    {
+        touched.insert(name);
+        StatementSet &statements = variables[name].*which;
+        if (add && (statements.empty() || (*statements.rbegin())->order < statement->order))
+            statements.insert(statements.end(), statement); // Первая сборка и дописывание в конец - без поиска
+        else if (add)
+            statements.insert(statement);
+        else
+            statements.erase(statement);
+    };
+    for (const VariableUse &use : statement->fragment.unresolved)
+        update(&VariableLinks::uses, use.name);
+    for (const string &name : statement->fragment.defined)
+        update(&VariableLinks::definitions, name);
+    const Fragment &fragment = statement->fragment;
+    if (fragment.syntax_error || !fragment.lexical_error.empty() || !fragment.reached_end)
+    {
+        if (add)
+            stops.insert(statement);
+        else
+            stops.erase(statement);
+    }
+}
+
+bool IncrementalCompiler::usedBeforeDefinition(const string &name, const Statement *statement) const
+{
+    if (!undefined.count(name))
+        return false;
+    const StatementSet &definitions = variables.at(name).definitions;
+    return definitions.empty() || statement->order <= (*definitions.begin())->order;
+}
+
+IncrementalCompiler::Slot &IncrementalCompiler::slotOf(const Statement *statement)
+{
+    return *partition_point(slots.begin(), slots.end(), [&](const Slot &slot) { return slot.statement->order < statement->order; });
+}
+
+bool IncrementalCompiler::compile(string text, ostream &out, ostream &err)
+{
+    size_t old_size = source.size(), new_size = text.size();
+    size_t limit = min(old_size, new_size);
+    size_t prefix = commonPrefix(source.data(), text.data(), limit);
+    size_t suffix = commonSuffix(source.data() + old_size, text.data() + new_size, limit - prefix);
+
+    // Операторы, целиком лежащие в общем начале, остаются. Последний разбирается всегда: это может быть хвост
+    // без ';', к которому дописан текст
+    size_t first = slots.empty() ? 0 : static_cast<size_t>(partition_point(slots.begin(), slots.end() - 1, [&](const Slot &slot) { return slot.span.end <= prefix; }) - slots.begin());
+    StatementCursor cursor{text, first < slots.size() ? slots[first].span : SourceSpan{0, 0, 0, 0}};
+    vector<Slot> parsed;
+    size_t resync = slots.size(); // Первый старый оператор, который остаётся после разобранных заново
+    SourceSpan span;
+    for (size_t k = first; cursor.next(span);)
+    {
+        parsed.push_back(Slot{span, 0, span.row, make_unique<Statement>()});
+        if (cursor.at.begin + suffix < new_size)
+            continue;
+        // Граница в общем конце: ищется старая на том же месте (с поправкой на изменение длины)
+        while (k < slots.size() && slots[k].span.begin + new_size < cursor.at.begin + old_size)
+            ++k;
+        if (k < slots.size() && slots[k].span.begin + new_size == cursor.at.begin + old_size &&
+            slots[k].span.column == cursor.at.column)
+        {
+            resync = k;
+            break;
+        }
+    }
+    runParallel(threads, parsed.size(), [&](size_t i) { parseFragment(text, parsed[i].span, parsed[i].statement->fragment, false); });
+
+    // Старые операторы уходят из связей, пока ключи и множества согласованы
+    unordered_set<string> touched;
+    for (size_t i = first; i < resync; ++i)
+        link(slots[i].statement.get(), false, touched);
+
+    vector<OPSElement> added;
+    for (Slot &slot : parsed)
+    {
+        Fragment &fragment = slot.statement->fragment;
+        size_t label_base = next_label;
+        next_label += fragment.labels;
+        slot.ops = fragment.ops.size();
+        for (OPSElement &element : fragment.ops)
+        {
+            if (element.code == OPSCode::OP_LABEL && label_base != 0)
+                relocateLabel(element, label_base);
+            added.push_back(move(element));
+        }
+        vector<OPSElement>().swap(fragment.ops);
+    }
+    size_t from = 0, removed = 0;
+    for (size_t i = 0; i < first; ++i)
+        from += slots[i].ops;
+    for (size_t i = first; i < resync; ++i)
+        removed += slots[i].ops;
+    splice(ops_code, from, removed, added);
+
+    // Операторы после правки только сдвигаются (беззнаковое переполнение даёт нужную разность)
+    if (resync < slots.size())
+    {
+        size_t row_shift = cursor.at.row - slots[resync].span.row;
+        for (size_t i = resync; i < slots.size(); ++i)
+        {
+            slots[i].span.begin = slots[i].span.begin + new_size - old_size;
+            slots[i].span.end = slots[i].span.end + new_size - old_size;
+            slots[i].span.row += row_shift;
+        }
+    }
+    // Ключи новых операторов - поровну из промежутка между соседями; не хватило - все ключи заново
+    uint64_t low = first > 0 ? slots[first - 1].statement->order : 0;
+    uint64_t high = resync < slots.size() ? slots[resync].statement->order : UINT64_MAX;
+    splice(slots, first, resync - first, parsed);
+    uint64_t step = (high - low) / (parsed.size() + 1);
+    if (step == 0)
+    {
+        step = UINT64_MAX / (slots.size() + 1);
+        for (size_t i = 0; i < slots.size(); ++i)
+            slots[i].statement->order = step * (i + 1); // Порядок прежний, множества остаются упорядоченными
+    }
+    else
+        for (size_t i = 0; i < parsed.size(); ++i)
+            slots[first + i].statement->order = low + step * (i + 1);
+    for (size_t i = 0; i < parsed.size(); ++i)
+        link(slots[first + i].statement.get(), true, touched);
+    for (const string &name : touched)
+    {
+        auto links = variables.find(name);
+        const StatementSet &uses = links->second.uses, &definitions = links->second.definitions;
+        if (uses.empty() && definitions.empty())
+        {
+            variables.erase(links);
+            undefined.erase(name);
+        }
+        else if (!uses.empty() && (definitions.empty() || (*uses.begin())->order <= (*definitions.begin())->order))
+            undefined.insert(name);
+        else
+            undefined.erase(name);
+    }
+    source = move(text);
+    last_parsed = parsed.size();
+    return check(out, err);
+}
+
+bool IncrementalCompiler::check(ostream &out, ostream &err)
+{
+    Statement *stop = stops.empty() ? nullptr : *stops.begin();
+    vector<Statement *> reported;
+    for (const string &name : undefined)
+    {
+        const VariableLinks &links = variables.at(name);
+        for (Statement *statement : links.uses)
+        {
+            if (!usedBeforeDefinition(name, statement) || (stop && statement->order > stop->order))
+                break;
+            reported.push_back(statement);
+        }
+    }
+    sort(reported.begin(), reported.end(), ByOrder());
+    reported.erase(unique(reported.begin(), reported.end()), reported.end());
+
+    Slot *stop_slot = stop ? &slotOf(stop) : nullptr;
+    if (stop_slot && stop_slot->parsed_row != stop_slot->span.row)
+    {
+        // Строки в сообщении об ошибке сдвинулись: ОПС и переменные те же, сообщение - заново
+        Fragment fresh;
+        parseFragment(source, stop_slot->span, fresh, false);
+        vector<OPSElement>().swap(fresh.ops);
+        stop->fragment = move(fresh);
+        stop_slot->parsed_row = stop_slot->span.row;
+    }
+    for (Statement *statement : reported)
+    {
+        const Slot &slot = slotOf(statement);
+        for (const VariableUse &use : statement->fragment.unresolved)
+            if (usedBeforeDefinition(use.name, statement))
+                reportUndefinedVariable(err, VariableUse{use.name, use.row + slot.span.row - slot.parsed_row, use.column});
+    }
+    bool syntax_error = false, semantic_error = !reported.empty();
+    program_size = ops_code.size();
+    if (stop)
+    {
+        if (!stop->fragment.lexical_error.empty())
+            throw runtime_error(stop->fragment.lexical_error);
+        err << stop->fragment.messages;
+        syntax_error = stop->fragment.syntax_error;
+        program_size = 0;
+        for (const Slot *slot = slots.data(); slot <= stop_slot; ++slot)
+            program_size += slot->ops;
+    }
+    if (program_size < ops_code.size())
+        truncated.assign(ops_code.begin(), ops_code.begin() + static_cast<ptrdiff_t>(program_size));
+    else
+        vector<OPSElement>().swap(truncated);
+    reportParseResult(out, err, syntax_error, semantic_error);
+    return !syntax_error && !semantic_error;
+}
+} // namespace translator::detail
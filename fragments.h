@@ -0,0 +1,133 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <unordered_set>
+#include <unordered_map>
+#include <cstdint>
+#include "syntaxer.h"
+
+namespace translator::detail
+{
+// --- РАЗБОР ПО КУСКАМ ---
+// Текст делится на операторы верхнего уровня по ';' вне фигурных скобок: строк и комментариев в языке нет, поэтому
+// лексер для этого не нужен. Кусок - один или несколько операторов подряд; его лексер начинает со строки и столбца
+// начала куска, парсер - с пустой таблицей переменных и своими метками L0, L1, ... Куски разбираются независимо,
+// а склейка (planFragments и placeFragment) собирает их по порядку: перенумеровывает метки и доделывает проверку определённости переменных,
+// которой куску не хватило, - какие переменные определены до него. Определённость на входе куска только добавляется
+// к тому, что он определяет сам (и if/else, и while лишь пересекают или восстанавливают множества), поэтому
+// результат - те же ОПС и те же сообщения, что у Parser::parse() по всему тексту.
+
+// Кусок текста [begin, end), row и column - где он начинается (с нуля)
+struct SourceSpan
+{
+    size_t begin, end;
+    size_t row, column;
+};
+
+// Разобранный кусок
+struct Fragment
+{
+    vector<OPSElement> ops;
+    vector<SourcePosition> positions;
+    size_t labels = 0;                  // Метки куска - L0 .. L(labels - 1)
+    vector<VariableUse> unresolved;     // Переменные, не определённые в самом куске, в порядке использования
+    vector<string> defined;             // Определены к концу куска (при пустой таблице на входе)
+    string messages;                    // Сообщение о синтаксической ошибке
+    bool syntax_error = false;
+    string lexical_error;               // Исключение лексера; пусто - его не было
+    bool reached_end = false;           // Разобран весь кусок; иначе разбор остановился на лексеме, с которой не начинается оператор
+};
+
+// Разбор текста на threads потоках (--compile-threads); результат и сообщения - как у Parser::parse()
+bool parseParallel(const string &text, vector<OPSElement> &ops_code, vector<SourcePosition> *positions, unsigned threads,
+                   ostream &out, ostream &err);
+
+// --- ПЕРЕКОМПИЛЯЦИЯ ПОСЛЕ ПРАВКИ ---
+// Каждый оператор верхнего уровня - свой кусок. После правки заново разбираются только операторы, которые она задевает:
+// общие начало и конец старого и нового текста сравниваются блоками, операторы в общем начале остаются, а новые
+// границы ищутся от первого задетого оператора, пока граница не совпадёт со старой в общем конце (то же место и тот же
+// столбец - дальше тот же текст и те же операторы). Метки у оператора свои на всё время его жизни (новые операторы
+// получают ещё не занятые номера), поэтому ОПС остальных операторов не меняется, а новая вклеивается в ops_code на
+// место старой.
+// Проверка определённости тоже не проходит весь текст: у каждой переменной упорядоченные множества операторов,
+// которые её определяют и используют до определения в себе. Использование - ошибка, если оператор не позже первого
+// определяющего; пересчитываются только переменные изменённых операторов. Порядок операторов задают ключи order:
+// они растут по тексту, у оставшихся операторов не меняются, а новым достаются числа из промежутка между соседями.
+class IncrementalCompiler
+{
+    struct Statement
+    {
+        Fragment fragment;  // ОПС перенесена в ops_code
+        uint64_t order = 0;
+    };
+    struct ByOrder
+    {
+        bool operator()(const Statement *a, const Statement *b) const { return a->order < b->order; }
+    };
+    using StatementSet = set<Statement *, ByOrder>;
+    // Оператор в тексте: при вставке в середину сдвигаются только эти записи
+    struct Slot
+    {
+        SourceSpan span;
+        size_t ops;         // Сколько элементов ОПС
+        size_t parsed_row;  // span.row при разборе: строки в сообщениях куска - от неё
+        unique_ptr<Statement> statement;
+    };
+    struct VariableLinks
+    {
+        StatementSet definitions, uses;
+    };
+
+    unsigned threads;
+    string source;                      // Текст последней компиляции
+    vector<Slot> slots;
+    vector<OPSElement> ops_code;        // ОПС всех операторов подряд
+    vector<OPSElement> truncated;       // Программа, если разбор кончился раньше текста
+    size_t program_size = 0;
+    size_t next_label = 0;
+    size_t last_parsed = 0;
+    unordered_map<string, VariableLinks> variables;
+    unordered_set<string> undefined;    // Переменные, у которых есть использование не позже первого определения
+    StatementSet stops;                 // Операторы, на которых разбор кончается: ошибка или лексема не из оператора
+
+    // Длина общего начала a и b, не больше limit; сравнение блоками через memcmp
+    static size_t commonPrefix(const char *a, const char *b, size_t limit);
+    // Длина общего конца: a_end и b_end - концы текстов
+    static size_t commonSuffix(const char *a_end, const char *b_end, size_t limit);
+
+    // Заменяет [from, from + removed) в items на added
+    template <class T>
+    static void splice(vector<T> &items, size_t from, size_t removed, vector<T> &added);
+
+    // Связи оператора с переменными: add - добавить, иначе убрать; имена попадают в touched
+    void link(Statement *statement, bool add, unordered_set<string> &touched);
+
+    // Использование name в операторе statement - ошибка
+    bool usedBeforeDefinition(const string &name, const Statement *statement) const;
+
+    // Запись оператора по его ключу
+    Slot &slotOf(const Statement *statement);
+
+public:
+    explicit IncrementalCompiler(unsigned threads = 1) : threads(threads) {}
+
+    // Компилирует text (как из convert(): строки с '\n', в конце '\0'); сообщения и исключение лексера - как у
+    // Parser::parse(). Первый вызов разбирает всё, следующие - только операторы, задетые правкой.
+    // false - синтаксическая ошибка или переменная без значения.
+    bool compile(string text, ostream &out, ostream &err);
+
+    // ОПС последней компиляции
+    const vector<OPSElement> &program() const { return program_size < ops_code.size() ? truncated : ops_code; }
+    // Сколько операторов разобрано последней компиляцией и сколько их всего
+    size_t parsedStatements() const { return last_parsed; }
+    size_t totalStatements() const { return slots.size(); }
+
+private:
+    // Сообщения по связям, как у Parser::parse(): переменные без значения в порядке текста, затем ошибка оператора,
+    // на котором разбор кончается. Время - по числу ошибок, а не по размеру текста
+    bool check(ostream &out, ostream &err);
+};
+} // namespace translator::detail
@@ -0,0 +1,97 @@
+#include "input.h"
+#include <charconv>
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h> // Для read и close
+
+namespace translator::detail
+{
+bool parseNumber(const char *begin, const char *end, std::variant<int, float, std::string> &result)
+{
+    // from_chars не принимает ведущий '+', а stoi/stof принимали
+    if (end - begin > 1 && *begin == '+' && begin[1] != '-')
+        ++begin;
+    int int_val = 0;
+    std::from_chars_result parsed = std::from_chars(begin, end, int_val);
+    if (parsed.ec == std::errc() && parsed.ptr == end)
+    {
+        result = int_val;
+        return true;
+    }
+    if (parsed.ec == std::errc::result_out_of_range && parsed.ptr == end)
+        return false; // Целое, не влезающее в int, - ошибка ввода, как при интерактивном read, а не вещественное
+    float float_val = 0.0f;
+    parsed = std::from_chars(begin, end, float_val);
+    if (parsed.ec == std::errc() && parsed.ptr == end)
+    {
+        result = float_val;
+        return true;
+    }
+    return false;
+}
+
+bool InputReader::fill()
+{
+    if (at_eof || fd < 0)
+        return false;
+    if (begin > 0)
+    {
+        std::copy(buffer.begin() + begin, buffer.begin() + end, buffer.begin());
+        buffer_start += begin;
+        end -= begin;
+        begin = 0;
+    }
+    if (end == capacity)
+        return false;
+    ssize_t got;
+    do
+        got = ::read(fd, buffer.data() + end, capacity - end);
+    while (got < 0 && errno == EINTR);
+    if (got <= 0)
+    {
+        at_eof = true;
+        return false;
+    }
+    end += static_cast<size_t>(got);
+    return true;
+}
+
+InputReader::~InputReader()
+{
+    if (owns_fd)
+        ::close(fd);
+}
+
+void InputReader::append(const char *text, size_t size)
+{
+    // Прочитанное выбрасывается, позиции для сообщений считаются от начала всего ввода
+    buffer.erase(buffer.begin(), buffer.begin() + begin);
+    buffer_start += begin;
+    end -= begin;
+    begin = 0;
+    buffer.insert(buffer.end(), text, text + size);
+    end += size;
+    data = buffer.data();
+}
+
+bool InputReader::ready() const
+{
+    if (at_eof)
+        return true;
+    size_t scan = begin;
+    while (scan < end && isSpace(data[scan]))
+        ++scan;
+    while (scan < end && !isSpace(data[scan]))
+        ++scan;
+    return scan < end;
+}
+
+std::string InputReader::position() const
+{
+    std::string text = "value #" + std::to_string(words);
+    if (!stream)
+        text += " (line " + std::to_string(line) + ", column " + std::to_string(word_start - line_start + 1) +
+                ", byte " + std::to_string(word_start) + ")";
+    return text;
+}
+} // namespace translator::detail
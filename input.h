@@ -0,0 +1,130 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <variant>
+
+namespace translator::detail
+{
+// --- ВВОД ПРОГРАММЫ ---
+// read() берёт значения по одному слову. Интерактивно слово читается из потока через >> после приглашения.
+// В пакетном режиме (stdin или файл) вход читается большими блоками через read, приглашений нет,
+// а для сообщения об ошибке запоминается позиция слова: строка, столбец и смещение в байтах.
+// Запись пакетного прогона (--records) читается прямо из памяти, значения в ней разделены ещё и запятыми.
+// Сервису ввод приходит частями по сети: он дописывается через append(), а ready() говорит, есть ли целое слово.
+
+// Разбор числа без исключений: целое, если слово целиком целое, иначе вещественное. false - не число
+// или целое вне диапазона int.
+bool parseNumber(const char *begin, const char *end, std::variant<int, float, std::string> &result);
+
+class InputReader
+{
+private:
+    static const size_t capacity = 1 << 16; // Слово длиннее блока режется на части
+
+    std::istream *stream; // nullptr - читаем блоками из fd (или из buffer, который пополняет append())
+    int fd;
+    bool owns_fd;
+    std::string word; // Последнее слово интерактивного ввода
+
+    std::vector<char> buffer;
+    const char *data;    // Начало данных: buffer.data() или чужая память записи
+    size_t begin, end;   // Непрочитанная часть data
+    size_t buffer_start; // Смещение data[0] от начала входа
+    bool at_eof;
+    char separator;      // Разделитель помимо пробельных символов
+
+    size_t words;                                  // Сколько слов прочитано
+    size_t line, line_start, word_start; // Позиция последнего слова: строка, начало строки и слова в байтах
+
+    // Дочитывает вход в буфер, сдвигая непрочитанный остаток в начало. false - вход кончился.
+    bool fill();
+    bool isSpace(char c) const { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f' || c == separator; }
+
+public:
+    explicit InputReader(std::istream &in)
+        : stream(&in), fd(-1), owns_fd(false), data(nullptr), begin(0), end(0), buffer_start(0), at_eof(false), separator(' '),
+          words(0), line(1), line_start(0), word_start(0) {}
+    // owns - закрыть дескриптор в деструкторе (файл, открытый по --input)
+    explicit InputReader(int descriptor, bool owns = false)
+        : stream(nullptr), fd(descriptor), owns_fd(owns), buffer(capacity), data(buffer.data()), begin(0), end(0), buffer_start(0),
+          at_eof(false), separator(' '), words(0), line(1), line_start(0), word_start(0) {}
+    // Готовый текст [first, last) без копирования; line_number - номер его строки для сообщений об ошибках
+    InputReader(const char *first, const char *last, size_t line_number, char extra_separator)
+        : stream(nullptr), fd(-1), owns_fd(false), data(first), begin(0), end(static_cast<size_t>(last - first)), buffer_start(0),
+          at_eof(true), separator(extra_separator), words(0), line(line_number), line_start(0), word_start(0) {}
+    // Ввод, который приходит частями: append() дописывает, finish() отмечает конец
+    explicit InputReader(char extra_separator)
+        : stream(nullptr), fd(-1), owns_fd(false), data(nullptr), begin(0), end(0), buffer_start(0), at_eof(false),
+          separator(extra_separator), words(0), line(1), line_start(0), word_start(0) {}
+    ~InputReader();
+    InputReader(const InputReader &) = delete;
+    InputReader &operator=(const InputReader &) = delete;
+
+    void append(const char *text, size_t size);
+    void finish() { at_eof = true; }
+    // next() не упрётся в недописанное слово: в буфере есть слово с разделителем после него, или ввод закончен
+    bool ready() const;
+
+    // Интерактивный ввод: перед чтением нужно приглашение
+    bool interactive() const { return stream != nullptr; }
+
+    // Следующее слово ввода в [first, last). Указатели живут до следующего вызова. false - ввод кончился.
+    bool next(const char *&first, const char *&last)
+    {
+        if (stream)
+        {
+            ++words;
+            if (!(*stream >> word))
+                return false;
+            first = word.data();
+            last = first + word.size();
+            return true;
+        }
+        // Пропуск пробелов с подсчётом строк
+        for (;;)
+        {
+            while (begin < end && isSpace(data[begin]))
+            {
+                if (data[begin] == '\n')
+                {
+                    ++line;
+                    line_start = buffer_start + begin + 1;
+                }
+                ++begin;
+            }
+            if (begin < end)
+                break;
+            if (!fill())
+            {
+                ++words; // Позиция того значения, которого не хватило
+                word_start = buffer_start + begin;
+                return false;
+            }
+        }
+        // Слово целиком в буфере: если упёрлись в конец блока, дочитываем
+        size_t scan = begin;
+        for (;;)
+        {
+            while (scan < end && !isSpace(data[scan]))
+                ++scan;
+            if (scan < end || at_eof)
+                break;
+            size_t offset = scan - begin;
+            bool more = fill(); // Сдвигает буфер даже когда читать нечего
+            scan = begin + offset;
+            if (!more)
+                break;
+        }
+        ++words;
+        word_start = buffer_start + begin;
+        first = data + begin;
+        last = data + scan;
+        begin = scan;
+        return true;
+    }
+
+    // Где лежит последнее прочитанное (или недостающее) слово, для сообщений об ошибках
+    std::string position() const;
+};
+} // namespace translator::detail
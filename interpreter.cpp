@@ -1,442 +1,511 @@
-using namespace std;
-#include <iostream>
-#include <vector>
-#include <string>
-#include <unordered_map>
-#include <variant>   // Для   variant
-#include <stdexcept> // Для   runtime_error
-#include "syntaxer.cpp"
-// --- ИНТЕРПРЕТАТОР (Задача 3) ---
-class Interpreter
-{
-private:
-    // Стек для выполнения ОПС (операнды, промежуточные результаты)
-    //   variant позволяет хранить int или float
-    vector<variant<int, float, string>> runtime_stack;
-
-    bool undefined_var; // отслеживаем необъявленные переменные
-    // Таблица переменных
-    // Хранит имена переменных и их текущие значения (int или float)
-    unordered_map<string, variant<int, float, string>> symbol_table;
-
-    // Карта для разрешения меток: имя метки (L1:) -> индекс в векторе ops_code
-    unordered_map<string, size_t> label_addresses;
-
-    // Вектор с последовательностью ОПС
-    const vector<OPSElement> &ops_code; // Ссылка на сгенерированный код ОПС
-
-    // Вспомогательные функции для стека
-    void push(variant<int, float, string> val)
-    {
-        runtime_stack.push_back(val);
-    }
-
-    variant<int, float, string> pop()
-    {
-        if (runtime_stack.empty())
-        {
-            throw runtime_error("Runtime Error: Stack underflow.");
-        }
-        variant<int, float, string> val = runtime_stack.back();
-        runtime_stack.pop_back();
-        return val;
-    }
-
-    // Вспомогательные функции для операций
-    variant<int, float, string> perform_binary_op(variant<int, float, string> op1, variant<int, float, string> op2, OPSCode op_code);
-    bool is_false(const variant<int, float, string> &val);
-
-    // Подготовка меток перед выполнением
-    void resolve_labels();
-
-public:
-    Interpreter(const vector<OPSElement> &code);
-    void run(); // Запускает выполнение ОПС
-};
-
-// Конструктор интерпретатора
-Interpreter::Interpreter(const vector<OPSElement> &code) : undefined_var(false), ops_code(code)
-{
-    // Разрешаем метки сразу после создания
-    resolve_labels();
-}
-
-// Разрешение меток (заполнение label_addresses)
-void Interpreter::resolve_labels()
-{
-    for (size_t i = 0; i < ops_code.size(); ++i)
-    {
-        if (ops_code[i].code == OPSCode::OP_LABEL)
-            // Метки хранятся как строки, например "L1:"
-            label_addresses[get<string>(ops_code[i].value)] = i;
-    }
-}
-
-// Выполнение бинарных операций (арифметика и сравнения)
-variant<int, float, string> Interpreter::perform_binary_op(variant<int, float, string> op1, variant<int, float, string> op2, OPSCode op_code)
-{
-    // Обработка типов: если один из операндов float, результат float
-    bool is_float = holds_alternative<float>(op1) || holds_alternative<float>(op2);
-
-    float f_op1 = is_float ? (holds_alternative<float>(op1) ? get<float>(op1) : static_cast<float>(get<int>(op1))) : 0.0f;
-    float f_op2 = is_float ? (holds_alternative<float>(op2) ? get<float>(op2) : static_cast<float>(get<int>(op2))) : 0.0f;
-
-    int i_op1 = holds_alternative<int>(op1) ? get<int>(op1) : static_cast<int>(get<float>(op1));
-    int i_op2 = holds_alternative<int>(op2) ? get<int>(op2) : static_cast<int>(get<float>(op2));
-
-    // Результаты сравнений всегда int (0 или 1)
-    if (op_code == OPSCode::OP_LS || op_code == OPSCode::OP_LE || op_code == OPSCode::OP_GS ||
-        op_code == OPSCode::OP_GE || op_code == OPSCode::OP_EQ || op_code == OPSCode::OP_NE)
-    {
-        bool result = true;
-        if (is_float)
-        {
-            switch (op_code)
-            {
-            case OPSCode::OP_LS:
-                result = f_op1 < f_op2;
-                break;
-            case OPSCode::OP_LE:
-                result = f_op1 <= f_op2;
-                break;
-            case OPSCode::OP_GS:
-                result = f_op1 > f_op2;
-                break;
-            case OPSCode::OP_GE:
-                result = f_op1 >= f_op2;
-                break;
-            case OPSCode::OP_EQ:
-                result = f_op1 == f_op2;
-                break;
-            case OPSCode::OP_NE:
-                result = f_op1 != f_op2;
-                break;
-            }
-        }
-        else
-        {
-            switch (op_code)
-            {
-            case OPSCode::OP_LS:
-                result = i_op1 < i_op2;
-                break;
-            case OPSCode::OP_LE:
-                result = i_op1 <= i_op2;
-                break;
-            case OPSCode::OP_GS:
-                result = i_op1 > i_op2;
-                break;
-            case OPSCode::OP_GE:
-                result = i_op1 >= i_op2;
-                break;
-            case OPSCode::OP_EQ:
-                result = i_op1 == i_op2;
-                break;
-            case OPSCode::OP_NE:
-                result = i_op1 != i_op2;
-                break;
-            }
-        }
-        return result;
-    }
-
-    // Арифметические операции
-    if (is_float)
-    {
-        if (op_code == OPSCode::OP_ADD)
-            return f_op1 + f_op2;
-        if (op_code == OPSCode::OP_SUB)
-            return f_op1 - f_op2;
-        if (op_code == OPSCode::OP_MUL)
-            return f_op1 * f_op2;
-        if (op_code == OPSCode::OP_DIV)
-        {
-            if (f_op2 == 0.0f)
-                throw runtime_error("Runtime Error: Division by zero (float).");
-            return f_op1 / f_op2;
-        }
-    }
-    else
-    {
-        if (op_code == OPSCode::OP_ADD)
-            return i_op1 + i_op2;
-        if (op_code == OPSCode::OP_SUB)
-            return i_op1 - i_op2;
-        if (op_code == OPSCode::OP_MUL)
-            return i_op1 * i_op2;
-        if (op_code == OPSCode::OP_DIV)
-        {
-            if (i_op2 == 0)
-                throw runtime_error("Runtime Error: Division by zero (integer).");
-            return i_op1 / i_op2;
-        }
-    }
-    throw runtime_error("Internal Error: Unknown binary operation.");
-}
-
-// Проверка, является ли значение "ложным" для условных переходов
-bool Interpreter::is_false(const variant<int, float, string> &val)
-{
-    if (holds_alternative<int>(val))
-    {
-        return get<int>(val) == 0;
-    }
-    else if (holds_alternative<float>(val))
-    {
-        return get<float>(val) == 0.0f;
-    }
-    return true; // Неожиданный тип, трактуем как ложь
-}
-
-// Запуск выполнения ОПС
-void Interpreter::run()
-{
-    size_t program_counter = 0; // Указатель на текущую инструкцию ОПС
-
-    while (program_counter < ops_code.size())
-    {
-        const OPSElement &current_element = ops_code[program_counter];
-        program_counter++; // Переходим к следующей инструкции по умолчанию
-
-        try
-        {
-            switch (current_element.code)
-            {
-            // --- Операнды (помещаются на стек) ---
-            case OPSCode::OP_INT_CONST:
-                // cout << get<int>(current_element.value);
-                push(get<int>(current_element.value));
-                break;
-            case OPSCode::OP_FLOAT_CONST:
-                // cout << get<float>(current_element.value);
-                push(get<float>(current_element.value));
-                break;
-            case OPSCode::OP_IDENT:
-            {
-                string var_name = get<string>(current_element.value);
-                // cout << get<string>(current_element.value);
-                if (symbol_table.count(var_name))
-                {
-                    push(var_name); // symbol_table[var_name]
-                }
-                else if (undefined_var) // За раз можем объявить только одну переменную
-                                        // Если уже встретили уже вторую не объявленную это точно исключение
-                    throw runtime_error("Runtime error: Undefined variable");
-                else
-                {
-                    push(var_name);       // symbol_table[var_name]
-                    undefined_var = true; // Встретили не объявленную переменную, обработаем позже
-                }
-                break;
-            }
-
-            // --- Арифметические операции ---
-            case OPSCode::OP_ADD:
-            case OPSCode::OP_SUB:
-            case OPSCode::OP_MUL:
-            case OPSCode::OP_DIV:
-            // --- Сравнения ---
-            case OPSCode::OP_LS:
-            case OPSCode::OP_LE:
-            case OPSCode::OP_GS:
-            case OPSCode::OP_GE:
-            case OPSCode::OP_EQ:
-            case OPSCode::OP_NE:
-            {
-                variant<int, float, string> op2 = pop();
-                variant<int, float, string> op1 = pop();
-                while (holds_alternative<string>(op1)) 
-                {
-                    string var = get<string>(op1);
-                    if (symbol_table.count(var))
-                        op1 = symbol_table[var];
-                    else
-                        throw runtime_error("Runtime Error: Undefined variable.");
-                }
-                while (holds_alternative<string>(op2))
-                {
-                    string var = get<string>(op2);
-                    if (symbol_table.count(var))
-                        op2 = symbol_table[var];
-                    else
-                        throw runtime_error("Runtime Error: Undefined variable.");
-                }
-                push(perform_binary_op(op1, op2, current_element.code));
-                break;
-            }
-
-                // --- Управление потоком ---
-
-            case OPSCode::OP_LABEL:
-                // Метки - это просто маркеры, интерпретатор их пропускает
-                break;
-            case OPSCode::OP_JF:
-            {
-                variant<int, float, string> condition_result = pop();
-                string target_label_name = get<string>(ops_code[program_counter - 2].value);
-
-                if (is_false(condition_result))
-                {
-                    // Переходим к адресу метки
-                    if (label_addresses.count(target_label_name))
-                    {
-                        program_counter = label_addresses[target_label_name + ":"];
-                    }
-                    else
-                    {
-                        throw runtime_error("Runtime Error: Undefined label '" + target_label_name + "'.");
-                    }
-                }
-                break;
-            }
-            case OPSCode::OP_JMP:
-            {
-                string target_label_name = get<string>(ops_code[program_counter - 2].value); // Метка находится на текущей позиции PC
-
-                // Безусловный переход
-                if (label_addresses.count(target_label_name))
-                {
-                    program_counter = label_addresses[target_label_name + ":"];
-                }
-                else
-                {
-                    throw runtime_error("Runtime Error: Undefined label '" + target_label_name + "'.");
-                }
-                break;
-            }
-
-            // --- Память ---
-            case OPSCode::OP_ASSIGN:
-            {
-                string var_name = get<string>(pop()); // Получаем имя переменной с вершины стека
-                // Ожидаем, что следующая инструкция - это OP_IDENT с именем переменной  || !holds_alternative<string>(runtime_stack.back())
-                if (runtime_stack.empty())
-                {
-                    throw runtime_error("Internal Error: ASSIGN expected variable name on stack.");
-                }
-                //  string var_name = get<string>(pop());
-                variant<int, float, string> value_to_assign = pop();
-                
-                if (undefined_var && symbol_table.count(var_name))
-                    throw runtime_error("Runtime Error: Undefined variable.");
-                // Объявляем ту что на вершине стека иначе ошибка
-                symbol_table[var_name] = value_to_assign;
-                undefined_var = false;
-                break;
-            }
-            // --- Ввод/Вывод ---
-            case OPSCode::OP_READ:
-            {
-                // Ожидаем, что следующая инструкция - это OP_IDENT с именем переменной || !holds_alternative<string>(runtime_stack.back())
-                if (runtime_stack.empty())
-                {
-                    throw runtime_error("Internal Error: READ expected variable name on stack.");
-                }
-                string var_name = get<string>(pop()); // Получаем имя переменной с вершины стека
-                // string var_name = get<string>(current_element.value);
-                cout << "Enter value for " << var_name << ": ";
-                string input_str;
-                cin >> input_str;
-
-                // Пробуем преобразовать в int или float
-                try
-                {
-                    size_t pos_int;
-                    int int_val = stoi(input_str, &pos_int);
-                    if (pos_int == input_str.length())
-                    { // Вся строка - int
-                        symbol_table[var_name] = int_val;
-                        undefined_var = false;
-                    }
-                    else
-                    { // Может быть float
-                        size_t pos_float;
-                        float float_val = stof(input_str, &pos_float);
-                        if (pos_float == input_str.length())
-                        { // Вся строка - float
-                            symbol_table[var_name] = float_val;
-                            undefined_var = false;
-                        }
-                        else
-                        {
-                            throw runtime_error("Runtime Error: Invalid input for variable '" + var_name + "'.");
-                        }
-                    }
-                }
-                catch (const exception &e)
-                {
-                    throw runtime_error("Runtime Error: Invalid input format for variable '" + var_name + "'. " + e.what());
-                }
-                break;
-            }
-            case OPSCode::OP_PRINT:
-            {
-                if (undefined_var)
-                    throw runtime_error("Runtime Error: Undefined variable.");
-                variant<int, float, string> val = pop();
-                if (holds_alternative<int>(val))
-                {
-                    cout << get<int>(val) << endl;
-                }
-                else if (holds_alternative<float>(val))
-                {
-                    cout << get<float>(val) << endl;
-                }
-                else if (holds_alternative<string>(val))
-                {
-                    // Достаём значение переменной по таблице
-                    variant<int, float, string> result = symbol_table[get<string>(val)];
-                    if (holds_alternative<int>(result))
-                        cout << "value of " << get<string>(val) << ": " << get<int>(result) << endl;
-                    else if (holds_alternative<float>(result))
-                        cout << "value of " << get<string>(val) << ": " << get<float>(result) << endl;
-                    else
-                        throw runtime_error("Print Error: chtopopalo v steke.");
-                }
-                break;
-            }
-            case OPSCode::OP_ERROR:
-                throw runtime_error("Internal Error: Encountered OP_ERROR in OPS code.");
-            }
-        }
-        catch (const runtime_error &e)
-        {
-            cerr << e.what() << " OPS index: " << program_counter - 1 << endl;
-            break; // Останавливаем выполнение при первой же ошибке
-        }
-        catch (const bad_variant_access &e)
-        {
-            cerr << "Internal Runtime Error: Type mismatch in OPS element value at index " << program_counter - 1 << ". " << e.what() << endl;
-            break;
-        }
-    }
-}
-// --- Главная функция программы ---
-int main()
-{
-    string filename = "test.txt"; // Укажите правильный путь к файлу
-
-    string text = convert(filename);
-    cout << text;
-    // Создаем лексер с текстом из файла
-    Lexer lexer(text);
-
-    vector<OPSElement> ops_code;
-    // Создаем парсер, передавая ему лексер
-    Parser parser(lexer, ops_code);
-
-    // Запускаем процесс парсинга
-    parser.parse();
-
-    // Печатаем сгенерированную ОПС, если не было ошибок синтаксиса
-    if (!parser.hasSyntaxError())
-    {
-        printOPS(ops_code);
-        Interpreter inter(ops_code);
-        cout << endl
-             << "--- Inter running... ---" << endl;
-        inter.run();
-        return 0;
-    }
-    return 1; // Возвращаем ненулевой код для ошибки синтаксиса или лексической ошибки
-}
+#include "interpreter.h"
+#include <cstdint>   // Для   SIZE_MAX
+
+namespace translator::detail
+{
+FloatFormat printFormatOf(const vector<OPSElement> &ops_code)
+{
+    for (const OPSElement &element : ops_code)
+        if (element.code == OPSCode::OP_FLOAT_CONST)
+            return {chars_format::fixed, 2};
+    return {chars_format::general, 6};
+}
+
+bool compileSource(const string &source, vector<OPSElement> &ops_code, FloatFormat &float_format, ostream &messages,
+                   const OptimizerOptions *optimizer)
+{
+    // Лексер ждёт текст в том же виде, что даёт convert(): строки с '\n' и завершающий '\0'
+    string text = source;
+    if (text.empty() || text.back() != '\n')
+        text += '\n';
+    text += '\0';
+    Lexer lexer(text);
+    bool ok = false;
+    try
+    {
+        Parser parser(lexer, ops_code, messages, messages);
+        parser.parse();
+        ok = !parser.hasSyntaxError() && !parser.hasSemanticErrors();
+    }
+    catch (const runtime_error &e)
+    {
+        messages << e.what() << endl; // Лексическая ошибка
+    }
+    if (!ok)
+    {
+        ops_code.clear();
+        return false;
+    }
+    float_format = printFormatOf(ops_code);
+    if (optimizer)
+    {
+        OptimizerOptions options = *optimizer;
+        options.out = options.err = &messages;
+        optimizeOPS(ops_code, options);
+    }
+    return true;
+}
+
+// Конструктор интерпретатора
+Interpreter::Interpreter(const vector<OPSElement> &code)
+    : ops_code(code), io(nullptr), program_counter(0), executed(0), limited(false), limit_exceeded(false), clock_countdown(0),
+      profile(nullptr), track_stack(false), peak_stack(0), trace(nullptr)
+{
+    // Разрешаем метки сразу после создания
+    resolve_labels();
+}
+
+// Разрешение меток (заполнение label_addresses)
+void Interpreter::resolve_labels()
+{
+    for (size_t i = 0; i < ops_code.size(); ++i)
+    {
+        if (ops_code[i].code == OPSCode::OP_LABEL)
+            // Метки хранятся как строки, например "L1:"
+            label_addresses[get<string>(ops_code[i].value)] = i;
+    }
+}
+
+// Выполнение бинарных операций (арифметика и сравнения)
+variant<int, float, string> Interpreter::perform_binary_op(variant<int, float, string> op1, variant<int, float, string> op2, OPSCode op_code)
+{
+    // Обработка типов: если один из операндов float, результат float
+    bool is_float = holds_alternative<float>(op1) || holds_alternative<float>(op2);
+
+    float f_op1 = is_float ? (holds_alternative<float>(op1) ? get<float>(op1) : static_cast<float>(get<int>(op1))) : 0.0f;
+    float f_op2 = is_float ? (holds_alternative<float>(op2) ? get<float>(op2) : static_cast<float>(get<int>(op2))) : 0.0f;
+
+    int i_op1 = holds_alternative<int>(op1) ? get<int>(op1) : static_cast<int>(get<float>(op1));
+    int i_op2 = holds_alternative<int>(op2) ? get<int>(op2) : static_cast<int>(get<float>(op2));
+
+    // Результаты сравнений всегда int (0 или 1)
+    if (op_code == OPSCode::OP_LS || op_code == OPSCode::OP_LE || op_code == OPSCode::OP_GS ||
+        op_code == OPSCode::OP_GE || op_code == OPSCode::OP_EQ || op_code == OPSCode::OP_NE)
+    {
+        bool result = true;
+        if (is_float)
+        {
+            switch (op_code)
+            {
+            case OPSCode::OP_LS:
+                result = f_op1 < f_op2;
+                break;
+            case OPSCode::OP_LE:
+                result = f_op1 <= f_op2;
+                break;
+            case OPSCode::OP_GS:
+                result = f_op1 > f_op2;
+                break;
+            case OPSCode::OP_GE:
+                result = f_op1 >= f_op2;
+                break;
+            case OPSCode::OP_EQ:
+                result = f_op1 == f_op2;
+                break;
+            case OPSCode::OP_NE:
+                result = f_op1 != f_op2;
+                break;
+            }
+        }
+        else
+        {
+            switch (op_code)
+            {
+            case OPSCode::OP_LS:
+                result = i_op1 < i_op2;
+                break;
+            case OPSCode::OP_LE:
+                result = i_op1 <= i_op2;
+                break;
+            case OPSCode::OP_GS:
+                result = i_op1 > i_op2;
+                break;
+            case OPSCode::OP_GE:
+                result = i_op1 >= i_op2;
+                break;
+            case OPSCode::OP_EQ:
+                result = i_op1 == i_op2;
+                break;
+            case OPSCode::OP_NE:
+                result = i_op1 != i_op2;
+                break;
+            }
+        }
+        return result;
+    }
+
+    // Арифметические операции
+    if (is_float)
+    {
+        if (op_code == OPSCode::OP_ADD)
+            return f_op1 + f_op2;
+        if (op_code == OPSCode::OP_SUB)
+            return f_op1 - f_op2;
+        if (op_code == OPSCode::OP_MUL)
+            return f_op1 * f_op2;
+        if (op_code == OPSCode::OP_DIV)
+        {
+            if (f_op2 == 0.0f)
+                throw runtime_error("Runtime Error: Division by zero (float).");
+            return f_op1 / f_op2;
+        }
+    }
+    else
+    {
+        if (op_code == OPSCode::OP_ADD)
+            return i_op1 + i_op2;
+        if (op_code == OPSCode::OP_SUB)
+            return i_op1 - i_op2;
+        if (op_code == OPSCode::OP_MUL)
+            return i_op1 * i_op2;
+        if (op_code == OPSCode::OP_DIV)
+        {
+            if (i_op2 == 0)
+                throw runtime_error("Runtime Error: Division by zero (integer).");
+            return i_op1 / i_op2;
+        }
+    }
+    throw runtime_error("Internal Error: Unknown binary operation.");
+}
+
+// Целое деление на константу без деления: старшая половина произведения на магическое число (см. divisionMagic).
+// Результат тот же, что у i_op1 / i_op2, включая округление к нулю для отрицательных.
+int Interpreter::divide_by_magic(int dividend, int divisor, size_t magic)
+{
+    int multiplier = static_cast<int>(static_cast<uint32_t>(magic));
+    int shift = static_cast<int>(magic >> 32);
+    int q = static_cast<int>((static_cast<int64_t>(multiplier) * dividend) >> 32);
+    if (divisor > 0 && multiplier < 0)
+        q = static_cast<int>(static_cast<uint32_t>(q) + static_cast<uint32_t>(dividend));
+    else if (divisor < 0 && multiplier > 0)
+        q = static_cast<int>(static_cast<uint32_t>(q) - static_cast<uint32_t>(dividend));
+    q >>= shift;
+    return q + static_cast<int>(static_cast<uint32_t>(q) >> 31); // +1 для отрицательного частного
+}
+
+// Проверка, является ли значение "ложным" для условных переходов
+bool Interpreter::is_false(const variant<int, float, string> &val)
+{
+    if (holds_alternative<int>(val))
+    {
+        return get<int>(val) == 0;
+    }
+    else if (holds_alternative<float>(val))
+    {
+        return get<float>(val) == 0.0f;
+    }
+    return true; // Неожиданный тип, трактуем как ложь
+}
+
+// Запуск выполнения ОПС
+void Interpreter::start(RuntimeIO &runtime_io, const RunLimits &run_limits)
+{
+    io = &runtime_io;
+    limits = run_limits;
+    limited = limits.max_instructions != 0 || limits.max_time.count() != 0;
+    limit_exceeded = false;
+    peak_stack = 0;
+    if (limited)
+    {
+        started_at = chrono::steady_clock::now();
+        deadline = started_at + limits.max_time;
+        clock_countdown = clock_check_interval;
+    }
+    runtime_stack.clear();
+    symbol_table.clear();
+    error_message.clear();
+    waiting_for.clear();
+    program_counter = 0;
+    executed = 0;
+}
+
+bool Interpreter::restore(RuntimeIO &runtime_io, const InterpreterState &state, const RunLimits &run_limits)
+{
+    start(runtime_io, run_limits);
+    if (state.program_counter > ops_code.size())
+        return false;
+    program_counter = state.program_counter;
+    executed = state.executed; // Ограничение на инструкции считает и выполненные до снимка
+    runtime_stack = state.stack;
+    symbol_table.reserve(state.variables.size());
+    for (const auto &variable : state.variables)
+        symbol_table.insert(variable);
+    return true;
+}
+
+InterpreterState Interpreter::state() const
+{
+    InterpreterState state;
+    state.program_counter = program_counter;
+    state.executed = executed;
+    state.stack = runtime_stack;
+    state.variables.assign(symbol_table.begin(), symbol_table.end());
+    return state;
+}
+
+void Interpreter::reload()
+{
+    label_addresses.clear();
+    resolve_labels();
+    program_counter = 0;
+    runtime_stack.clear();
+}
+
+bool Interpreter::clock_expired()
+{
+    clock_countdown = clock_check_interval;
+    return chrono::steady_clock::now() >= deadline;
+}
+
+void Interpreter::stop_on_limit(size_t done, bool out_of_fuel)
+{
+    string reason = out_of_fuel ? "instruction budget of " + to_string(limits.max_instructions) + " exhausted"
+                                : "time limit of " + to_string(chrono::duration_cast<chrono::milliseconds>(limits.max_time).count()) + " ms exceeded";
+    limit_exceeded = true;
+    auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started_at);
+    throw runtime_error("Limit Error: " + reason + " after " + to_string(done) + " instructions, " +
+                        to_string(elapsed.count() / 1000) + "." + to_string(elapsed.count() % 1000 / 100) + " ms.");
+}
+
+RunStatus Interpreter::resume(size_t max_instructions)
+{
+    if (!profile && !track_stack && !trace)
+        return execute<false>(max_instructions);
+    RunStatus status = execute<true>(max_instructions);
+    if (profile)
+        profile->close(profileTicks()); // Время последнего элемента до выхода из отрезка
+    peak_stack = max(peak_stack, runtime_stack.size()); // Глубина после последней инструкции
+    return status;
+}
+
+template <bool instrumented>
+RunStatus Interpreter::execute(size_t max_instructions)
+{
+    size_t budget = max_instructions != 0 ? max_instructions : SIZE_MAX;
+    size_t remaining = budget;
+    waiting_for.clear();
+    while (program_counter < ops_code.size())
+    {
+        if (remaining == 0)
+        {
+            executed += budget;
+            return RunStatus::Yielded;
+        }
+        --remaining;
+        if constexpr (instrumented)
+        {
+            if (profile)
+                profile->enter(program_counter);
+            // Инструкция кладёт на стек только в конце, поэтому глубина на границах инструкций - наибольшая
+            if (runtime_stack.size() > peak_stack)
+                peak_stack = runtime_stack.size();
+        }
+        const OPSElement &current_element = ops_code[program_counter];
+        program_counter++; // Переходим к следующей инструкции по умолчанию
+
+        try
+        {
+            switch (current_element.code)
+            {
+            // --- Операнды (помещаются на стек) ---
+            case OPSCode::OP_INT_CONST:
+                // cout << get<int>(current_element.value);
+                push(get<int>(current_element.value));
+                break;
+            case OPSCode::OP_FLOAT_CONST:
+                // cout << get<float>(current_element.value);
+                push(get<float>(current_element.value));
+                break;
+            case OPSCode::OP_IDENT:
+                // Имя кладётся как есть: значением оно станет в операции, цель присваивания/ввода так и остаётся именем
+                push(get<string>(current_element.value));
+                break;
+
+            // --- Арифметические операции ---
+            case OPSCode::OP_ADD:
+            case OPSCode::OP_SUB:
+            case OPSCode::OP_MUL:
+            case OPSCode::OP_DIV:
+            // --- Сравнения ---
+            case OPSCode::OP_LS:
+            case OPSCode::OP_LE:
+            case OPSCode::OP_GS:
+            case OPSCode::OP_GE:
+            case OPSCode::OP_EQ:
+            case OPSCode::OP_NE:
+            {
+                variant<int, float, string> op2 = value_of(pop());
+                variant<int, float, string> op1 = value_of(pop());
+                push(perform_binary_op(op1, op2, current_element.code));
+                break;
+            }
+
+            // --- Умножение и деление на целую константу (после оптимизатора) ---
+            // Константа на стеке нужна для float: тогда операция обычная, но без проверки делителя на ноль
+            case OPSCode::OP_MUL_POW2:
+            {
+                int constant = get<int>(pop());
+                variant<int, float, string> op1 = value_of(pop());
+                if (holds_alternative<int>(op1))
+                    push(static_cast<int>(static_cast<uint32_t>(get<int>(op1)) << get<size_t>(current_element.value)));
+                else
+                    push(get<float>(op1) * static_cast<float>(constant));
+                break;
+            }
+            case OPSCode::OP_DIV_CONST:
+            {
+                int divisor = get<int>(pop());
+                variant<int, float, string> op1 = value_of(pop());
+                if (holds_alternative<int>(op1))
+                    push(divide_by_magic(get<int>(op1), divisor, get<size_t>(current_element.value)));
+                else
+                    push(get<float>(op1) / static_cast<float>(divisor));
+                break;
+            }
+
+                // --- Управление потоком ---
+
+            case OPSCode::OP_LABEL:
+                // Метки - это просто маркеры, интерпретатор их пропускает
+                break;
+            case OPSCode::OP_JF:
+            case OPSCode::OP_JT:
+            {
+                variant<int, float, string> condition_result = value_of(pop());
+                string target_label_name = get<string>(ops_code[program_counter - 2].value);
+
+                // JT (после оптимизатора) переходит по истинному условию
+                bool jump = is_false(condition_result) == (current_element.code == OPSCode::OP_JF);
+                if constexpr (instrumented)
+                    if (trace && !trace->branch(jump))
+                        throw runtime_error("Replay Error: Branch #" + to_string(trace->next_branch) +
+                                            (jump ? " was taken" : " was not taken") + ", unlike in the trace.");
+                if (jump)
+                {
+                    // Переходим к адресу метки
+                    auto target = label_addresses.find(target_label_name + ":");
+                    if (target != label_addresses.end())
+                    {
+                        if (limited && target->second < program_counter)
+                            check_limits(executed + budget - remaining, false);
+                        program_counter = target->second;
+                    }
+                    else
+                    {
+                        throw runtime_error("Runtime Error: Undefined label '" + target_label_name + "'.");
+                    }
+                }
+                break;
+            }
+            case OPSCode::OP_JMP:
+            {
+                string target_label_name = get<string>(ops_code[program_counter - 2].value); // Метка находится на текущей позиции PC
+
+                // Безусловный переход
+                auto target = label_addresses.find(target_label_name + ":");
+                if (target != label_addresses.end())
+                {
+                    if (limited && target->second < program_counter)
+                        check_limits(executed + budget - remaining, false); // Обратный переход - очередная итерация цикла
+                    program_counter = target->second;
+                }
+                else
+                {
+                    throw runtime_error("Runtime Error: Undefined label '" + target_label_name + "'.");
+                }
+                break;
+            }
+
+            // --- Память ---
+            case OPSCode::OP_ASSIGN:
+            {
+                string var_name = get<string>(pop()); // Получаем имя переменной с вершины стека
+                // Ожидаем, что следующая инструкция - это OP_IDENT с именем переменной  || !holds_alternative<string>(runtime_stack.back())
+                if (runtime_stack.empty())
+                {
+                    throw runtime_error("Internal Error: ASSIGN expected variable name on stack.");
+                }
+                // Копируем значение: для "a = b;" на стеке лежит имя b, а не его значение
+                symbol_table[var_name] = value_of(pop());
+                break;
+            }
+            // --- Ввод/Вывод ---
+            case OPSCode::OP_READ:
+            {
+                if (limited)
+                    check_limits(executed + budget - remaining, true);
+                // Ожидаем, что следующая инструкция - это OP_IDENT с именем переменной || !holds_alternative<string>(runtime_stack.back())
+                if (runtime_stack.empty())
+                {
+                    throw runtime_error("Internal Error: READ expected variable name on stack.");
+                }
+                string var_name = get<string>(pop()); // Получаем имя переменной с вершины стека
+                // После оптимизатора значение может храниться не в исходной переменной, тогда её имя лежит в value
+                const string &prompt_name = holds_alternative<string>(current_element.value) ? get<string>(current_element.value) : var_name;
+                variant<int, float, string> read_val;
+                string read_error;
+                ReadStatus read_status = io->read(prompt_name, read_val, read_error);
+                if (read_status == ReadStatus::Failed)
+                    throw runtime_error(read_error);
+                if (read_status == ReadStatus::Pending)
+                {
+                    // Откат к началу READ: имя обратно на стек, инструкция не засчитывается
+                    waiting_for = prompt_name;
+                    push(var_name);
+                    --program_counter;
+                    if constexpr (instrumented)
+                        if (profile)
+                            --profile->counts[program_counter]; // READ выполнится заново
+                    executed += budget - remaining - 1;
+                    io->flush(); // Всё напечатанное до ожидания должно дойти до хоста
+                    return RunStatus::NeedsInput;
+                }
+                symbol_table[var_name] = read_val;
+                break;
+            }
+            case OPSCode::OP_PRINT:
+            {
+                if (limited)
+                    check_limits(executed + budget - remaining, false); // Часы - как на переходах: print не ждёт
+                variant<int, float, string> val = pop();
+                if (holds_alternative<string>(current_element.value))
+                {
+                    // Имя для печати задано явно (после оптимизатора), пустое - печать без имени
+                    io->print(get<string>(current_element.value), value_of(val));
+                }
+                else if (holds_alternative<string>(val))
+                {
+                    // Достаём значение переменной по таблице
+                    variant<int, float, string> result = value_of(val);
+                    if (holds_alternative<string>(result))
+                        throw runtime_error("Print Error: chtopopalo v steke.");
+                    io->print(get<string>(val), result);
+                }
+                else
+                {
+                    io->print(string(), val);
+                }
+                break;
+            }
+            case OPSCode::OP_ERROR:
+                throw runtime_error("Internal Error: Encountered OP_ERROR in OPS code.");
+            }
+        }
+        catch (const runtime_error &e)
+        {
+            error_message = string(e.what()) + " OPS index: " + to_string(program_counter - 1);
+            break; // Останавливаем выполнение при первой же ошибке
+        }
+        catch (const bad_variant_access &e)
+        {
+            error_message = "Internal Runtime Error: Type mismatch in OPS element value at index " + to_string(program_counter - 1) + ". " + e.what();
+            break;
+        }
+    }
+    executed += budget - remaining;
+    io->flush(); // Всё напечатанное до ошибки выходит раньше сообщения о ней
+    if (limit_exceeded)
+        return RunStatus::LimitExceeded;
+    return error_message.empty() ? RunStatus::Finished : RunStatus::Failed;
+}
+} // namespace translator::detail
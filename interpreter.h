@@ -0,0 +1,296 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <variant>   // Для   variant
+#include <stdexcept> // Для   runtime_error
+#include <chrono>    // Для   RunLimits
+#include "syntaxer.h"
+#include "optimizer.h"
+#include "output.h"
+#include "input.h"
+#include "profiler.h"
+#include "trace.h"
+#include "snapshot.h"
+
+namespace translator::detail
+{
+// --- ВВОД-ВЫВОД ВЫПОЛНЕНИЯ ---
+// read() и print() идут через RuntimeIO, сам интерпретатор не знает ни про потоки, ни про дескрипторы.
+// StreamIO - ввод-вывод командной строки, библиотека (translator.cpp) подставляет обработчики хоста.
+
+// Чем закончилась попытка read()
+enum class ReadStatus
+{
+    Ready,  // Значение получено
+    Failed, // Значения нет и не будет, в error причина
+    Pending // Значения пока нет: выполнение приостанавливается и повторит read() при следующем resume()
+};
+
+class RuntimeIO
+{
+public:
+    virtual ~RuntimeIO() {}
+    // Значение для read(name)
+    virtual ReadStatus read(const string &name, variant<int, float, string> &value, string &error) = 0;
+    // print(): name пустое, если печатается значение без имени
+    virtual void print(const string &name, const variant<int, float, string> &value) = 0;
+    // Выполнение закончено или остановлено ошибкой: всё накопленное должно уйти
+    virtual void flush() {}
+};
+
+// Печать в OutputBuffer ("value of x: 5"), значения из InputReader с приглашением в интерактивном режиме
+class StreamIO : public RuntimeIO
+{
+private:
+    OutputBuffer &output;
+    InputReader &input;
+
+public:
+    StreamIO(OutputBuffer &out, InputReader &in) : output(out), input(in) {}
+
+    ReadStatus read(const string &name, variant<int, float, string> &value, string &error) override
+    {
+        if (input.interactive())
+        {
+            output.write("Enter value for ");
+            output.write(name);
+            output.write(": ");
+            output.flush(); // Приглашение должно быть видно до ввода
+        }
+        const char *first, *last;
+        if (!input.next(first, last))
+        {
+            error = "Runtime Error: Input ended before value for variable '" + name + "', " + input.position() + ".";
+            return ReadStatus::Failed;
+        }
+        // Целое, если слово целиком целое, иначе вещественное
+        if (!parseNumber(first, last, value))
+        {
+            error = "Runtime Error: Invalid input '" + string(first, last) + "' for variable '" + name + "', " + input.position() + ".";
+            return ReadStatus::Failed;
+        }
+        return ReadStatus::Ready;
+    }
+    void print(const string &name, const variant<int, float, string> &value) override
+    {
+        if (!name.empty())
+        {
+            output.write("value of ");
+            output.write(name);
+            output.write(": ");
+        }
+        if (holds_alternative<int>(value))
+            output.writeInt(get<int>(value));
+        else
+            output.writeFloat(get<float>(value));
+        output.writeChar('\n');
+    }
+    void flush() override { output.flush(); }
+};
+
+// Ввод-вывод записи и воспроизведения поверх обычного: печать идёт в inner, read() при записи берёт значение у inner
+// и запоминает его, при воспроизведении отдаёт записанное и терминал не трогает
+class TraceIO : public RuntimeIO
+{
+private:
+    RuntimeIO &inner;
+    ExecutionTrace &trace;
+
+public:
+    TraceIO(RuntimeIO &io, ExecutionTrace &target) : inner(io), trace(target) {}
+
+    ReadStatus read(const string &name, variant<int, float, string> &value, string &error) override
+    {
+        if (trace.replaying)
+        {
+            if (trace.next_input >= trace.inputs.size())
+            {
+                error = "Replay Error: The trace has no more input for variable '" + name + "'.";
+                return ReadStatus::Failed;
+            }
+            const variant<int, float> &recorded = trace.inputs[trace.next_input++];
+            if (holds_alternative<int>(recorded))
+                value = get<int>(recorded);
+            else
+                value = get<float>(recorded);
+            return ReadStatus::Ready;
+        }
+        ReadStatus status = inner.read(name, value, error);
+        if (status == ReadStatus::Ready)
+        {
+            if (holds_alternative<int>(value))
+                trace.inputs.push_back(get<int>(value));
+            else
+                trace.inputs.push_back(get<float>(value));
+        }
+        return status;
+    }
+    void print(const string &name, const variant<int, float, string> &value) override
+    {
+        inner.print(name, value);
+    }
+    void flush() override
+    {
+        inner.flush();
+    }
+};
+
+// Формат печати вещественных без обращения к cout: такой же, какой printOPS включает у cout -
+// fixed с двумя знаками, если в ОПС есть вещественная константа
+FloatFormat printFormatOf(const vector<OPSElement> &ops_code);
+
+// Разбор текста программы в ОПС без печати в cout/cerr: сообщения лексера, парсера и оптимизатора идут в messages.
+// float_format - формат печати, выбранный по ОПС до оптимизации. optimizer == nullptr - без оптимизации.
+// false - в программе ошибки, ОПС пустая.
+bool compileSource(const string &source, vector<OPSElement> &ops_code, FloatFormat &float_format, ostream &messages,
+                   const OptimizerOptions *optimizer);
+
+// --- ИНТЕРПРЕТАТОР (Задача 3) ---
+// Чем закончился очередной отрезок выполнения
+enum class RunStatus
+{
+    Finished,     // Программа дошла до конца
+    Failed,       // Остановлена ошибкой, текст в error()
+    Yielded,      // Исчерпан отрезок инструкций, resume() продолжит с того же места
+    NeedsInput,   // read() ждёт значения (RuntimeIO вернул Pending); resume() повторит этот read()
+    LimitExceeded // Исчерпан RunLimits, текст со статистикой в error()
+};
+
+// Ограничения для чужих программ. Проверяются не на каждой инструкции, а только на обратных переходах
+// (раз за итерацию цикла) и на read/print, поэтому бюджет может быть превышен не больше чем на одно тело цикла.
+struct RunLimits
+{
+    size_t max_instructions = 0;    // Инструкций с start(), 0 - без ограничения
+    chrono::nanoseconds max_time{0}; // Время с start(), 0 - без ограничения; ожидание ввода вне resume() тоже считается
+};
+
+class Interpreter
+{
+private:
+    // Стек для выполнения ОПС (операнды, промежуточные результаты)
+    //   variant позволяет хранить int или float
+    vector<variant<int, float, string>> runtime_stack;
+
+    // Таблица переменных
+    // Хранит имена переменных и их текущие значения (int или float)
+    unordered_map<string, variant<int, float, string>> symbol_table;
+
+    // Карта для разрешения меток: имя метки (L1:) -> индекс в векторе ops_code
+    unordered_map<string, size_t> label_addresses;
+
+    // Вектор с последовательностью ОПС
+    const vector<OPSElement> &ops_code; // Ссылка на сгенерированный код ОПС
+
+    // Состояние выполнения между отрезками resume()
+    RuntimeIO *io;
+    size_t program_counter; // Указатель на текущую инструкцию ОПС
+    size_t executed;        // Выполнено инструкций с start()
+    string error_message;   // Ошибка, на которой остановилось выполнение
+    string waiting_for;     // Имя, которому ждёт значения read() после NeedsInput
+
+    // Ограничения выполнения
+    RunLimits limits;
+    bool limited;                          // Задано хоть одно ограничение
+    bool limit_exceeded;                   // Выполнение остановил check_limits
+    chrono::steady_clock::time_point started_at, deadline;
+    unsigned clock_countdown;              // Часы опрашиваются раз в clock_check_interval проверок
+    static const unsigned clock_check_interval = 256;
+
+    ExecutionProfile *profile; // Счётчики режима профиля, nullptr - профиль не собирается
+    bool track_stack;          // Следить за глубиной стека (--stats)
+    size_t peak_stack;         // Наибольшая глубина runtime_stack с start()
+    ExecutionTrace *trace;     // Запись или сверка исходов переходов (--record, --replay), nullptr - без трассы
+
+    // Вспомогательные функции для стека
+    void push(variant<int, float, string> val)
+    {
+        runtime_stack.push_back(val);
+    }
+
+    variant<int, float, string> pop()
+    {
+        if (runtime_stack.empty())
+        {
+            throw runtime_error("Runtime Error: Stack underflow.");
+        }
+        variant<int, float, string> val = runtime_stack.back();
+        runtime_stack.pop_back();
+        return val;
+    }
+
+    // Имя переменной на стеке заменяется её значением.
+    // Парсер уже проверил, что переменная определена до использования, поэтому поиск не проверяется.
+    variant<int, float, string> value_of(const variant<int, float, string> &val)
+    {
+        if (holds_alternative<string>(val))
+            return symbol_table.find(get<string>(val))->second;
+        return val;
+    }
+
+    // Вспомогательные функции для операций
+    variant<int, float, string> perform_binary_op(variant<int, float, string> op1, variant<int, float, string> op2, OPSCode op_code);
+    int divide_by_magic(int dividend, int divisor, size_t magic);
+    bool is_false(const variant<int, float, string> &val);
+
+    // Подготовка меток перед выполнением
+    void resolve_labels();
+    // Цикл выполнения; копия с instrumented == true ведёт профиль, глубину стека и трассу, копия без него их не касается
+    template <bool instrumented>
+    RunStatus execute(size_t max_instructions);
+    // Бросает исключение, если done инструкций или время вышли за limits.
+    // at_io - опросить часы сразу (перед read, который может ждать), иначе раз в clock_check_interval вызовов.
+    // Встраивается принудительно: вызов в цикле выполнения мешает GCC держать состояние цикла в регистрах.
+    [[gnu::always_inline]] void check_limits(size_t done, bool at_io)
+    {
+        bool out_of_fuel = limits.max_instructions != 0 && done >= limits.max_instructions;
+        if (out_of_fuel || (limits.max_time.count() != 0 && (at_io || --clock_countdown == 0) && clock_expired()))
+            stop_on_limit(done, out_of_fuel);
+    }
+    bool clock_expired();
+    [[noreturn]] void stop_on_limit(size_t done, bool out_of_fuel);
+
+public:
+    Interpreter(const vector<OPSElement> &code);
+    // Готовит выполнение с чистыми стеком и переменными.
+    // Один интерпретатор можно запускать много раз, ОПС при этом только читается.
+    void start(RuntimeIO &runtime_io, const RunLimits &run_limits = RunLimits());
+    // Как start(), но с позиции, стеком и переменными из снимка (state()); false - снимок не от этой ОПС
+    bool restore(RuntimeIO &runtime_io, const InterpreterState &state, const RunLimits &run_limits = RunLimits());
+    // Состояние между отрезками resume() для снимка; program_hash не заполняется
+    InterpreterState state() const;
+    // --stream: ОПС по той же ссылке заменена следующим оператором. Метки разрешаются заново, выполнение идёт
+    // с начала новой ОПС; переменные, счётчик инструкций и отсчёт ограничений от start() сохраняются.
+    void reload();
+    // Выполняет не больше max_instructions инструкций (0 - без ограничения). Между вызовами состояние сохраняется
+    // (PC, стек, переменные), поэтому несколько программ могут выполняться по очереди на одном потоке,
+    // а программа, которой не хватило ввода, ждёт его без занятого потока.
+    RunStatus resume(size_t max_instructions);
+    // Собирать профиль в target (накапливается между запусками), nullptr - выключить
+    void collectProfile(ExecutionProfile *target)
+    {
+        profile = target;
+        if (profile)
+            profile->prepare(ops_code.size());
+    }
+    // Запоминать наибольшую глубину стека (peakStack())
+    void trackStackDepth(bool on) { track_stack = on; }
+    // Записывать исходы условных переходов в target или, если он воспроизводится, сверять с ним; nullptr - выключить
+    void traceBranches(ExecutionTrace *target) { trace = target; }
+    // Другой ввод-вывод для следующих resume(): хост может сменить обработчики, пока программа ждёт
+    void attach(RuntimeIO &runtime_io) { io = &runtime_io; }
+    // Выполнение целиком; false - остановлено ошибкой или ограничением
+    bool run(RuntimeIO &runtime_io, const RunLimits &run_limits = RunLimits())
+    {
+        start(runtime_io, run_limits);
+        return resume(0) == RunStatus::Finished;
+    }
+    const string &error() const { return error_message; }
+    size_t instructions() const { return executed; }
+    size_t peakStack() const { return peak_stack; }
+    size_t variables() const { return symbol_table.size(); }
+    const string &pendingInput() const { return waiting_for; }
+};
+
+} // namespace translator::detail
@@ -0,0 +1,1345 @@
+#include "ir.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <sstream>
+#include <cstdlib>
+
+namespace translator::detail
+{
+// Предшественники пересчитываются по succs; порядок - по номерам блоков
+void IRFunction::computePreds()
+{
+    for (auto &block : blocks)
+        block.preds.clear();
+    for (size_t b = 0; b < blocks.size(); ++b)
+    {
+        if (blocks[b].removed)
+            continue;
+        for (int s : blocks[b].succs)
+            blocks[s].preds.push_back(static_cast<int>(b));
+    }
+}
+
+// Блоки, до которых нельзя дойти от входа, помечаются удалёнными
+void IRFunction::removeUnreachable()
+{
+    std::vector<char> reached(blocks.size(), 0);
+    std::vector<int> work = {0};
+    reached[0] = 1;
+    while (!work.empty())
+    {
+        int b = work.back();
+        work.pop_back();
+        for (int s : blocks[b].succs)
+            if (!reached[s])
+            {
+                reached[s] = 1;
+                work.push_back(s);
+            }
+    }
+    for (size_t b = 0; b < blocks.size(); ++b)
+        if (!reached[b] && !blocks[b].removed)
+        {
+            blocks[b].removed = true;
+            blocks[b].code.clear();
+            blocks[b].succs.clear();
+        }
+    computePreds();
+    // Входы Phi из выброшенных блоков больше не нужны
+    for (auto &block : blocks)
+        for (int id : block.code)
+        {
+            IRInstr &phi = instrs[id];
+            if (phi.op != IROp::Phi)
+                break;
+            for (size_t k = phi.phi_blocks.size(); k-- > 0;)
+                if (blocks[phi.phi_blocks[k]].removed)
+                {
+                    phi.phi_blocks.erase(phi.phi_blocks.begin() + k);
+                    phi.args.erase(phi.args.begin() + k);
+                }
+        }
+}
+
+// Обратный порядок обхода в глубину (без рекурсии: программы бывают очень длинными)
+std::vector<int> IRFunction::reversePostOrder() const
+{
+    std::vector<int> order;
+    std::vector<char> visited(blocks.size(), 0);
+    std::vector<std::pair<int, size_t>> stack = {{0, 0}};
+    visited[0] = 1;
+    while (!stack.empty())
+    {
+        auto &top = stack.back();
+        const BasicBlock &block = blocks[top.first];
+        if (top.second < block.succs.size())
+        {
+            int s = block.succs[top.second++];
+            if (!visited[s])
+            {
+                visited[s] = 1;
+                stack.push_back({s, 0});
+            }
+        }
+        else
+        {
+            order.push_back(top.first);
+            stack.pop_back();
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Непосредственные доминаторы (алгоритм Cooper-Harvey-Kennedy), -1 для выброшенных блоков
+std::vector<int> IRFunction::immediateDominators(const std::vector<int> &rpo) const
+{
+    std::vector<int> number(blocks.size(), -1);
+    for (size_t i = 0; i < rpo.size(); ++i)
+        number[rpo[i]] = static_cast<int>(i);
+
+    std::vector<int> idom(blocks.size(), -1);
+    idom[0] = 0;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 1; i < rpo.size(); ++i)
+        {
+            int b = rpo[i];
+            int new_idom = -1;
+            for (int p : blocks[b].preds)
+            {
+                if (idom[p] == -1)
+                    continue;
+                if (new_idom == -1)
+                {
+                    new_idom = p;
+                    continue;
+                }
+                int x = p, y = new_idom;
+                while (x != y)
+                {
+                    while (number[x] > number[y])
+                        x = idom[x];
+                    while (number[y] > number[x])
+                        y = idom[y];
+                }
+                new_idom = x;
+            }
+            if (idom[b] != new_idom)
+            {
+                idom[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+std::string constantToString(const std::variant<int, float> &c)
+{
+    if (std::holds_alternative<int>(c))
+        return std::to_string(std::get<int>(c));
+    std::ostringstream out;
+    out << std::get<float>(c);
+    std::string text = out.str();
+    if (text.find_first_of(".en") == std::string::npos)
+        text += ".0"; // Чтобы 3.0 отличалось от целого 3
+    return text;
+}
+
+std::string opsCodeName(OPSCode code)
+{
+    switch (code)
+    {
+    case OPSCode::OP_ADD:
+        return "add";
+    case OPSCode::OP_SUB:
+        return "sub";
+    case OPSCode::OP_MUL:
+        return "mul";
+    case OPSCode::OP_DIV:
+        return "div";
+    case OPSCode::OP_MUL_POW2:
+        return "mul.shl";
+    case OPSCode::OP_DIV_CONST:
+        return "div.magic";
+    case OPSCode::OP_LS:
+        return "lt";
+    case OPSCode::OP_LE:
+        return "le";
+    case OPSCode::OP_GS:
+        return "gt";
+    case OPSCode::OP_GE:
+        return "ge";
+    case OPSCode::OP_EQ:
+        return "eq";
+    case OPSCode::OP_NE:
+        return "ne";
+    default:
+        return "?";
+    }
+}
+
+// Печать IR (режим --dump-ir)
+void IRFunction::dump(std::ostream &out, const std::string &title) const
+{
+    auto value = [](int id)
+    { return id < 0 ? std::string("undef") : "%" + std::to_string(id); };
+
+    out << "\n--- IR: " << title << " ---" << std::endl;
+    for (size_t b = 0; b < blocks.size(); ++b)
+    {
+        const BasicBlock &block = blocks[b];
+        if (block.removed)
+            continue;
+        out << "B" << b << ":";
+        if (!block.preds.empty())
+        {
+            out << "    ; preds:";
+            for (int p : block.preds)
+                out << " B" << p;
+        }
+        out << std::endl;
+        for (int id : block.code)
+        {
+            const IRInstr &instr = instrs[id];
+            out << "    ";
+            switch (instr.op)
+            {
+            case IROp::Const:
+                out << value(id) << " = const " << constantToString(instr.constant);
+                break;
+            case IROp::Load:
+                out << value(id) << " = load " << instr.var;
+                break;
+            case IROp::Store:
+                out << "store " << instr.var << ", " << value(instr.args[0]);
+                break;
+            case IROp::Binary:
+                out << value(id) << " = " << opsCodeName(instr.bin) << " " << value(instr.args[0]) << ", " << value(instr.args[1]);
+                break;
+            case IROp::Phi:
+                out << value(id) << " = phi";
+                for (size_t k = 0; k < instr.args.size(); ++k)
+                    out << (k ? ", " : " ") << "[B" << instr.phi_blocks[k] << ": " << value(instr.args[k]) << "]";
+                break;
+            case IROp::Read:
+                out << value(id) << " = read " << instr.var;
+                break;
+            case IROp::Print:
+                out << "print " << value(instr.args[0]);
+                if (!instr.var.empty())
+                    out << " as " << instr.var;
+                break;
+            }
+            if ((instr.op == IROp::Binary || instr.op == IROp::Phi) && !instr.var.empty())
+                out << "    ; " << instr.var;
+            out << std::endl;
+        }
+        switch (block.term)
+        {
+        case IRTerm::Exit:
+            out << "    exit" << std::endl;
+            break;
+        case IRTerm::Jump:
+            out << "    jmp B" << block.succs[0] << std::endl;
+            break;
+        case IRTerm::Branch:
+            out << "    br " << value(block.cond) << ", B" << block.succs[0] << ", B" << block.succs[1] << std::endl;
+            break;
+        }
+    }
+}
+
+// --- ПОСТРОЕНИЕ CFG ПО ОПС ---
+// Блок начинается с определения метки и после каждого JF/JMP.
+// Стек ОПС внутри блока разворачивается в инструкции с явными Load/Store переменных.
+// Возвращает false, если ОПС не укладывается в эту схему (тогда оптимизация не выполняется).
+bool buildIR(const std::vector<OPSElement> &ops_code, IRFunction &fn)
+{
+    fn = IRFunction();
+    size_t n = ops_code.size();
+    std::vector<char> leader(n + 1, 0);
+    std::unordered_map<std::string, size_t> label_definitions; // "L1" -> индекс определения "L1:"
+    leader[0] = 1;
+    leader[n] = 1;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const OPSElement &element = ops_code[i];
+        if (element.code == OPSCode::OP_LABEL)
+        {
+            const std::string &name = std::get<std::string>(element.value);
+            if (!name.empty() && name.back() == ':')
+            {
+                leader[i] = 1;
+                label_definitions[name.substr(0, name.size() - 1)] = i;
+            }
+        }
+        else if (element.code == OPSCode::OP_JF || element.code == OPSCode::OP_JT || element.code == OPSCode::OP_JMP)
+            leader[i + 1] = 1;
+    }
+
+    // Пустой вход перед первым блоком: у цикла в самом начале программы тоже будет место для предзаголовка.
+    // Блок для каждого начала; блок на позиции n - пустой выход из программы
+    int entry = fn.addBlock();
+    std::vector<int> block_at(n + 1, -1);
+    std::vector<size_t> starts;
+    for (size_t i = 0; i <= n; ++i)
+        if (leader[i])
+        {
+            block_at[i] = fn.addBlock();
+            starts.push_back(i);
+        }
+    fn.blocks[entry].term = IRTerm::Jump;
+    fn.blocks[entry].succs = {block_at[0]};
+    for (size_t b = 0; b < fn.blocks.size(); ++b)
+        fn.layout.push_back(static_cast<int>(b));
+
+    // Операнд на стеке ОПС: имя переменной (ещё не прочитанной) или готовое значение
+    struct Operand
+    {
+        bool is_name;
+        std::string name;
+        int value;
+    };
+
+    for (size_t k = 0; k + 1 < starts.size(); ++k)
+    {
+        int b = block_at[starts[k]];
+        std::vector<Operand> stack;
+        std::string target; // Последняя ссылка на метку (перед JF/JMP)
+        bool terminated = false;
+        size_t i = starts[k]; // Текущий элемент ОПС - origin новых инструкций
+
+        auto emit = [&](const IRInstr &instr)
+        {
+            int id = fn.add(instr);
+            fn.instrs[id].origin = static_cast<int>(i);
+            fn.blocks[b].code.push_back(id);
+            return id;
+        };
+        auto pop = [&](Operand &operand)
+        {
+            if (stack.empty())
+                return false;
+            operand = stack.back();
+            stack.pop_back();
+            return true;
+        };
+        // Значение операнда; имя превращается в чтение переменной
+        auto valueOf = [&](const Operand &operand)
+        {
+            if (!operand.is_name)
+                return operand.value;
+            IRInstr load(IROp::Load);
+            load.var = operand.name;
+            return emit(load);
+        };
+        auto jumpTarget = [&](int &block)
+        {
+            auto it = label_definitions.find(target);
+            if (it == label_definitions.end())
+                return false;
+            block = block_at[it->second];
+            return true;
+        };
+
+        for (; i < starts[k + 1]; ++i)
+        {
+            const OPSElement &element = ops_code[i];
+            Operand a, c;
+            switch (element.code)
+            {
+            case OPSCode::OP_INT_CONST:
+            case OPSCode::OP_FLOAT_CONST:
+            {
+                IRInstr constant(IROp::Const);
+                if (element.code == OPSCode::OP_INT_CONST)
+                    constant.constant = std::get<int>(element.value);
+                else
+                    constant.constant = std::get<float>(element.value);
+                stack.push_back({false, "", emit(constant)});
+                break;
+            }
+            case OPSCode::OP_IDENT:
+                stack.push_back({true, std::get<std::string>(element.value), -1});
+                break;
+            case OPSCode::OP_ADD:
+            case OPSCode::OP_SUB:
+            case OPSCode::OP_MUL:
+            case OPSCode::OP_DIV:
+            case OPSCode::OP_MUL_POW2:
+            case OPSCode::OP_DIV_CONST:
+            case OPSCode::OP_LS:
+            case OPSCode::OP_LE:
+            case OPSCode::OP_GS:
+            case OPSCode::OP_GE:
+            case OPSCode::OP_EQ:
+            case OPSCode::OP_NE:
+            {
+                // Имена разрешаются в момент операции, как в интерпретаторе
+                if (!pop(c) || !pop(a))
+                    return false;
+                IRInstr binary(IROp::Binary);
+                binary.bin = element.code;
+                binary.args = {valueOf(a), valueOf(c)};
+                stack.push_back({false, "", emit(binary)});
+                break;
+            }
+            case OPSCode::OP_ASSIGN:
+            {
+                if (!pop(c) || !pop(a) || !c.is_name)
+                    return false;
+                IRInstr store(IROp::Store);
+                store.var = c.name;
+                store.args = {valueOf(a)};
+                emit(store);
+                break;
+            }
+            case OPSCode::OP_READ:
+            {
+                if (!pop(c) || !c.is_name)
+                    return false;
+                IRInstr read(IROp::Read);
+                read.var = std::holds_alternative<std::string>(element.value) ? std::get<std::string>(element.value) : c.name;
+                IRInstr store(IROp::Store);
+                store.var = c.name;
+                store.args = {emit(read)};
+                emit(store);
+                break;
+            }
+            case OPSCode::OP_PRINT:
+            {
+                if (!pop(a))
+                    return false;
+                IRInstr print(IROp::Print);
+                if (std::holds_alternative<std::string>(element.value))
+                    print.var = std::get<std::string>(element.value);
+                else if (a.is_name)
+                    print.var = a.name;
+                print.args = {valueOf(a)};
+                emit(print);
+                break;
+            }
+            case OPSCode::OP_LABEL:
+            {
+                const std::string &name = std::get<std::string>(element.value);
+                if (name.empty() || name.back() != ':')
+                    target = name;
+                break;
+            }
+            case OPSCode::OP_JF:
+            case OPSCode::OP_JT:
+            {
+                int jump_block;
+                if (!pop(a) || !jumpTarget(jump_block))
+                    return false;
+                fn.blocks[b].cond = valueOf(a);
+                fn.blocks[b].term = IRTerm::Branch;
+                if (element.code == OPSCode::OP_JF)
+                    fn.blocks[b].succs = {block_at[i + 1], jump_block};
+                else
+                    fn.blocks[b].succs = {jump_block, block_at[i + 1]};
+                terminated = true;
+                break;
+            }
+            case OPSCode::OP_JMP:
+            {
+                int jump_block;
+                if (!jumpTarget(jump_block))
+                    return false;
+                fn.blocks[b].term = IRTerm::Jump;
+                fn.blocks[b].succs = {jump_block};
+                terminated = true;
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        // Между блоками стек ОПС всегда пуст
+        if (!stack.empty())
+            return false;
+        if (!terminated)
+        {
+            fn.blocks[b].term = IRTerm::Jump;
+            fn.blocks[b].succs = {block_at[starts[k + 1]]};
+        }
+    }
+    fn.removeUnreachable();
+    return true;
+}
+
+// --- ПЕРЕВОД В SSA ---
+// Классическая схема: Phi ставятся на итерированной границе доминирования блоков с записями переменной,
+// затем переименование обходом дерева доминаторов. Load и Store исчезают, их места занимают значения.
+bool constructSSA(IRFunction &fn)
+{
+    std::vector<int> rpo = fn.reversePostOrder();
+    std::vector<int> idom = fn.immediateDominators(rpo);
+    size_t block_count = fn.blocks.size();
+
+    // Граница доминирования
+    std::vector<std::vector<int>> frontier(block_count);
+    for (int b : rpo)
+    {
+        const BasicBlock &block = fn.blocks[b];
+        if (block.preds.size() < 2)
+            continue;
+        for (int p : block.preds)
+        {
+            int runner = p;
+            while (runner != idom[b])
+            {
+                if (frontier[runner].empty() || frontier[runner].back() != b)
+                    frontier[runner].push_back(b);
+                runner = idom[runner];
+            }
+        }
+    }
+
+    // Места записи каждой переменной; Phi нужны только читаемым переменным
+    std::unordered_map<std::string, std::vector<int>> def_blocks;
+    std::unordered_set<std::string> loaded;
+    for (int b : rpo)
+        for (int id : fn.blocks[b].code)
+        {
+            const IRInstr &instr = fn.instrs[id];
+            if (instr.op == IROp::Store)
+            {
+                auto &defs = def_blocks[instr.var];
+                if (defs.empty() || defs.back() != b)
+                    defs.push_back(b);
+            }
+            else if (instr.op == IROp::Load)
+                loaded.insert(instr.var);
+        }
+
+    for (auto &[var, defs] : def_blocks)
+    {
+        if (!loaded.count(var))
+            continue;
+        std::vector<char> has_phi(block_count, 0), queued(block_count, 0);
+        std::vector<int> work = defs;
+        for (int b : defs)
+            queued[b] = 1;
+        while (!work.empty())
+        {
+            int x = work.back();
+            work.pop_back();
+            for (int y : frontier[x])
+            {
+                if (has_phi[y])
+                    continue;
+                has_phi[y] = 1;
+                IRInstr phi(IROp::Phi);
+                phi.var = var;
+                phi.phi_blocks = fn.blocks[y].preds;
+                phi.args.assign(phi.phi_blocks.size(), -1);
+                int id = fn.add(phi);
+                fn.blocks[y].code.insert(fn.blocks[y].code.begin(), id);
+                if (!queued[y])
+                {
+                    queued[y] = 1;
+                    work.push_back(y);
+                }
+            }
+        }
+    }
+
+    // Дерево доминаторов
+    std::vector<std::vector<int>> children(block_count);
+    for (int b : rpo)
+        if (b != 0)
+            children[idom[b]].push_back(b);
+
+    // Переименование: для каждой переменной стек текущих значений
+    std::unordered_map<std::string, std::vector<int>> current;
+    std::vector<int> replacement(fn.instrs.size(), -1);
+    auto resolve = [&](int id)
+    {
+        while (id >= 0 && id < static_cast<int>(replacement.size()) && replacement[id] != -1)
+            id = replacement[id];
+        return id;
+    };
+    bool ok = true;
+
+    struct Frame
+    {
+        int block;
+        size_t next_child;
+        std::vector<std::string> pushed;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({0, 0, {}});
+    bool entering = true;
+    while (!stack.empty())
+    {
+        Frame &frame = stack.back();
+        if (entering)
+        {
+            BasicBlock &block = fn.blocks[frame.block];
+            std::vector<int> kept;
+            for (int id : block.code)
+            {
+                IRInstr &instr = fn.instrs[id];
+                switch (instr.op)
+                {
+                case IROp::Phi:
+                    current[instr.var].push_back(id);
+                    frame.pushed.push_back(instr.var);
+                    kept.push_back(id);
+                    break;
+                case IROp::Load:
+                {
+                    auto it = current.find(instr.var);
+                    if (it == current.end() || it->second.empty())
+                        ok = false; // Чтение до записи: анализ определённости этого не пропускает
+                    else
+                        replacement[id] = it->second.back();
+                    break;
+                }
+                case IROp::Store:
+                {
+                    int value = resolve(instr.args[0]);
+                    IRInstr &def = fn.instrs[value];
+                    if (def.var.empty() && def.op == IROp::Binary)
+                        def.var = instr.var;
+                    current[instr.var].push_back(value);
+                    frame.pushed.push_back(instr.var);
+                    break;
+                }
+                default:
+                    for (int &arg : instr.args)
+                        arg = resolve(arg);
+                    kept.push_back(id);
+                    break;
+                }
+            }
+            block.code.swap(kept);
+            if (block.term == IRTerm::Branch)
+                block.cond = resolve(block.cond);
+
+            // Входы Phi в преемниках
+            for (int s : block.succs)
+                for (int id : fn.blocks[s].code)
+                {
+                    IRInstr &phi = fn.instrs[id];
+                    if (phi.op != IROp::Phi)
+                        break;
+                    auto it = current.find(phi.var);
+                    int value = (it == current.end() || it->second.empty()) ? -1 : it->second.back();
+                    for (size_t k = 0; k < phi.phi_blocks.size(); ++k)
+                        if (phi.phi_blocks[k] == frame.block && phi.args[k] == -1)
+                        {
+                            phi.args[k] = value;
+                            break;
+                        }
+                }
+            entering = false;
+        }
+        if (frame.next_child < children[frame.block].size())
+        {
+            int child = children[frame.block][frame.next_child++];
+            stack.push_back({child, 0, {}});
+            entering = true;
+            continue;
+        }
+        for (const std::string &var : frame.pushed)
+            current[var].pop_back();
+        stack.pop_back();
+    }
+    if (!ok)
+        return false;
+
+    // Чистка Phi: живы только те, что (через другие Phi) нужны обычным инструкциям или условиям
+    std::vector<char> live(fn.instrs.size(), 0);
+    std::vector<int> work;
+    for (int b : rpo)
+    {
+        const BasicBlock &block = fn.blocks[b];
+        for (int id : block.code)
+            if (fn.instrs[id].op != IROp::Phi)
+                for (int arg : fn.instrs[id].args)
+                    if (arg >= 0 && fn.instrs[arg].op == IROp::Phi && !live[arg])
+                    {
+                        live[arg] = 1;
+                        work.push_back(arg);
+                    }
+        if (block.term == IRTerm::Branch && fn.instrs[block.cond].op == IROp::Phi && !live[block.cond])
+        {
+            live[block.cond] = 1;
+            work.push_back(block.cond);
+        }
+    }
+    while (!work.empty())
+    {
+        int id = work.back();
+        work.pop_back();
+        for (int arg : fn.instrs[id].args)
+            if (arg >= 0 && fn.instrs[arg].op == IROp::Phi && !live[arg])
+            {
+                live[arg] = 1;
+                work.push_back(arg);
+            }
+    }
+
+    // Тривиальные Phi (все входы - одно значение или сама Phi) заменяются этим значением
+    replacement.assign(fn.instrs.size(), -1);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int b : rpo)
+            for (int id : fn.blocks[b].code)
+            {
+                IRInstr &phi = fn.instrs[id];
+                if (phi.op != IROp::Phi)
+                    break;
+                if (!live[id] || replacement[id] != -1)
+                    continue;
+                int same = -2;
+                bool trivial = true;
+                for (int &arg : phi.args)
+                {
+                    arg = resolve(arg);
+                    if (arg == id || arg == same)
+                        continue;
+                    if (same != -2 || arg == -1)
+                    {
+                        trivial = false;
+                        break;
+                    }
+                    same = arg;
+                }
+                if (trivial && same >= 0)
+                {
+                    replacement[id] = same;
+                    changed = true;
+                }
+            }
+    }
+    for (int b : rpo)
+    {
+        BasicBlock &block = fn.blocks[b];
+        std::vector<int> kept;
+        for (int id : block.code)
+        {
+            IRInstr &instr = fn.instrs[id];
+            if (instr.op == IROp::Phi && (!live[id] || replacement[id] != -1))
+                continue;
+            for (int &arg : instr.args)
+                arg = resolve(arg);
+            kept.push_back(id);
+        }
+        block.code.swap(kept);
+        if (block.term == IRTerm::Branch)
+            block.cond = resolve(block.cond);
+    }
+    fn.ssa = true;
+    return true;
+}
+
+// --- ОПУСКАНИЕ SSA ОБРАТНО В ОПС ---
+// Значение, которое используется один раз сразу за своим вычислением, остаётся на стеке ОПС
+// (так восстанавливаются исходные выражения). Остальные значения хранятся в переменных:
+// по возможности в исходной, при пересечении времён жизни - во временной "$tN".
+// Phi превращаются в присваивания в конце предшественников (критические рёбра разрезаются).
+class IRLowering
+{
+private:
+    IRFunction fn;
+    std::vector<OPSElement> ops;
+    std::vector<int> origins; // Для каждого элемента ops - origin инструкции, которая его выпустила
+    int current_origin;
+    std::vector<int> use_count;
+    std::vector<char> inlined;     // Значение вычисляется прямо в выражении-потребителе
+    std::vector<std::string> storage;
+    std::vector<int> def_block;
+    std::vector<char> is_edge_block; // Блок создан разрезанием ребра
+    int temp_counter;
+    int label_counter; // ОПС строится заново, поэтому метки нумеруются с нуля
+
+    bool producesValue(int id) const
+    {
+        IROp op = fn.instrs[id].op;
+        return op == IROp::Binary || op == IROp::Phi || op == IROp::Read || op == IROp::Const;
+    }
+    // Значение, которому нужна переменная
+    bool materialized(int id) const
+    {
+        return id >= 0 && producesValue(id) && fn.instrs[id].op != IROp::Const && !inlined[id];
+    }
+    std::string newTemp() { return "$t" + std::to_string(temp_counter++); }
+    std::string newLabel() { return "L" + std::to_string(label_counter++); }
+
+    void splitCriticalEdges();
+    void countUses();
+    void chooseInlined();
+    size_t claimOperands(const BasicBlock &block, int root, size_t cursor);
+    void assignStorage();
+    std::vector<std::pair<std::string, int>> phiCopies(int pred, int succ) const;
+
+    void emit(const OPSElement &element)
+    {
+        ops.push_back(element);
+        origins.push_back(current_origin);
+    }
+    // Следующие элементы выпускает инструкция id (если известно, откуда она)
+    void emitFor(int id)
+    {
+        if (id >= 0 && fn.instrs[id].origin >= 0)
+            current_origin = fn.instrs[id].origin;
+    }
+    OPSElement binaryElement(const IRInstr &instr) const;
+    void emitValue(int id);
+    void emitRoot(int id);
+    void emitCopies(const std::vector<std::pair<std::string, int>> &copies);
+
+public:
+    IRLowering(const IRFunction &function) : fn(function), current_origin(-1), temp_counter(0), label_counter(0) {}
+    std::vector<OPSElement> run();
+    const std::vector<int> &elementOrigins() const { return origins; }
+};
+
+void IRLowering::splitCriticalEdges()
+{
+    size_t original = fn.blocks.size();
+    is_edge_block.assign(original, 0);
+    for (size_t b = 0; b < original; ++b)
+    {
+        if (fn.blocks[b].removed || fn.blocks[b].term != IRTerm::Branch)
+            continue;
+        for (size_t k = 0; k < 2; ++k)
+        {
+            int s = fn.blocks[b].succs[k];
+            bool has_phi = !fn.blocks[s].code.empty() && fn.instrs[fn.blocks[s].code[0]].op == IROp::Phi;
+            if (!has_phi || fn.blocks[s].preds.size() < 2)
+                continue;
+            int edge = fn.addBlock();
+            is_edge_block.push_back(1);
+            fn.blocks[edge].term = IRTerm::Jump;
+            fn.blocks[edge].succs = {s};
+            fn.blocks[b].succs[k] = edge;
+            // Ровно один вход Phi от b переходит на новый блок
+            for (int id : fn.blocks[s].code)
+            {
+                IRInstr &phi = fn.instrs[id];
+                if (phi.op != IROp::Phi)
+                    break;
+                for (size_t j = 0; j < phi.phi_blocks.size(); ++j)
+                    if (phi.phi_blocks[j] == static_cast<int>(b))
+                    {
+                        phi.phi_blocks[j] = edge;
+                        break;
+                    }
+            }
+        }
+    }
+    fn.computePreds();
+}
+
+void IRLowering::countUses()
+{
+    use_count.assign(fn.instrs.size(), 0);
+    def_block.assign(fn.instrs.size(), -1);
+    for (size_t b = 0; b < fn.blocks.size(); ++b)
+    {
+        const BasicBlock &block = fn.blocks[b];
+        if (block.removed)
+            continue;
+        for (int id : block.code)
+        {
+            def_block[id] = static_cast<int>(b);
+            for (int arg : fn.instrs[id].args)
+                if (arg >= 0)
+                    use_count[arg]++;
+        }
+        if (block.term == IRTerm::Branch)
+            use_count[block.cond]++;
+    }
+}
+
+// Разбирает операнды корня root справа налево. Операнд встраивается, если он используется один раз
+// и вычислен непосредственно перед уже встроенной частью выражения - тогда порядок вычислений не меняется.
+size_t IRLowering::claimOperands(const BasicBlock &block, int root, size_t cursor)
+{
+    const std::vector<int> &args = fn.instrs[root].args;
+    for (size_t k = args.size(); k-- > 0;)
+    {
+        int arg = args[k];
+        if (arg < 0 || fn.instrs[arg].op == IROp::Const)
+            continue; // Константа печатается на месте
+        if (fn.instrs[arg].op != IROp::Binary || use_count[arg] != 1 || cursor == 0)
+            continue;
+        if (block.code[cursor - 1] != arg)
+            continue;
+        inlined[arg] = 1;
+        cursor = claimOperands(block, arg, cursor - 1);
+    }
+    return cursor;
+}
+
+void IRLowering::chooseInlined()
+{
+    inlined.assign(fn.instrs.size(), 0);
+    for (const BasicBlock &block : fn.blocks)
+    {
+        if (block.removed)
+            continue;
+        size_t cursor = block.code.size();
+        // Условие перехода - корень, стоящий после всех инструкций
+        if (block.term == IRTerm::Branch)
+        {
+            int cond = block.cond;
+            if (fn.instrs[cond].op == IROp::Binary && use_count[cond] == 1 && cursor > 0 && block.code[cursor - 1] == cond)
+            {
+                inlined[cond] = 1;
+                cursor = claimOperands(block, cond, cursor - 1);
+            }
+        }
+        while (cursor > 0)
+        {
+            int root = block.code[cursor - 1];
+            cursor = claimOperands(block, root, cursor - 1);
+        }
+    }
+}
+
+// Выбор переменных для хранения значений с проверкой пересечения времён жизни
+void IRLowering::assignStorage()
+{
+    // Временные переменные не должны совпасть с уже существующими "$tN"
+    for (const IRInstr &instr : fn.instrs)
+        if (instr.var.size() > 2 && instr.var.compare(0, 2, "$t") == 0)
+            temp_counter = std::max(temp_counter, std::atoi(instr.var.c_str() + 2) + 1);
+
+    storage.assign(fn.instrs.size(), "");
+    for (size_t id = 0; id < fn.instrs.size(); ++id)
+        if (def_block[id] != -1 && materialized(static_cast<int>(id)))
+            storage[id] = fn.instrs[id].var.empty() ? newTemp() : fn.instrs[id].var;
+
+    // Живость значений по блокам: от каждого использования вверх до определения
+    size_t block_count = fn.blocks.size();
+    std::vector<std::unordered_set<int>> live_in(block_count), live_out(block_count);
+    std::vector<int> work;
+    auto liveInto = [&](int value, int b)
+    {
+        work.push_back(b);
+        while (!work.empty())
+        {
+            int x = work.back();
+            work.pop_back();
+            if (x == def_block[value] || !live_in[x].insert(value).second)
+                continue;
+            for (int p : fn.blocks[x].preds)
+            {
+                live_out[p].insert(value);
+                work.push_back(p);
+            }
+        }
+    };
+    for (size_t b = 0; b < block_count; ++b)
+    {
+        const BasicBlock &block = fn.blocks[b];
+        if (block.removed)
+            continue;
+        for (int id : block.code)
+        {
+            const IRInstr &instr = fn.instrs[id];
+            for (size_t k = 0; k < instr.args.size(); ++k)
+            {
+                int arg = instr.args[k];
+                if (!materialized(arg))
+                    continue;
+                if (instr.op == IROp::Phi)
+                {
+                    // Вход Phi жив на выходе из соответствующего предшественника
+                    int pred = instr.phi_blocks[k];
+                    live_out[pred].insert(arg);
+                    liveInto(arg, pred);
+                }
+                else
+                    liveInto(arg, static_cast<int>(b));
+            }
+        }
+        if (block.term == IRTerm::Branch && materialized(block.cond))
+            liveInto(block.cond, static_cast<int>(b));
+    }
+
+    // Значение конфликтует, если в момент его записи жива другая величина в той же переменной
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t b = 0; b < block_count; ++b)
+        {
+            const BasicBlock &block = fn.blocks[b];
+            if (block.removed)
+                continue;
+            std::unordered_set<int> live = live_out[b];
+            std::unordered_map<std::string, int> live_count;
+            for (int id : live)
+                live_count[storage[id]]++;
+            auto use = [&](int id)
+            {
+                if (materialized(id) && live.insert(id).second)
+                    live_count[storage[id]]++;
+            };
+            auto define = [&](int id)
+            {
+                if (live.erase(id))
+                    live_count[storage[id]]--;
+                if (live_count[storage[id]] > 0)
+                {
+                    storage[id] = newTemp();
+                    changed = true;
+                }
+            };
+            if (block.term == IRTerm::Branch)
+                use(block.cond);
+            size_t phi_end = 0;
+            while (phi_end < block.code.size() && fn.instrs[block.code[phi_end]].op == IROp::Phi)
+                phi_end++;
+            for (size_t i = block.code.size(); i-- > phi_end;)
+            {
+                int id = block.code[i];
+                if (materialized(id))
+                    define(id);
+                for (int arg : fn.instrs[id].args)
+                    use(arg);
+            }
+            // Phi определяются одновременно на входе в блок
+            for (size_t i = 0; i < phi_end; ++i)
+                if (live.erase(block.code[i]))
+                    live_count[storage[block.code[i]]]--;
+            std::unordered_set<std::string> phi_storage;
+            for (size_t i = 0; i < phi_end; ++i)
+            {
+                int id = block.code[i];
+                if (live_count[storage[id]] > 0 || !phi_storage.insert(storage[id]).second)
+                {
+                    storage[id] = newTemp();
+                    phi_storage.insert(storage[id]);
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+// Присваивания на ребре pred -> succ: (переменная Phi, входное значение)
+std::vector<std::pair<std::string, int>> IRLowering::phiCopies(int pred, int succ) const
+{
+    std::vector<std::pair<std::string, int>> copies;
+    for (int id : fn.blocks[succ].code)
+    {
+        const IRInstr &phi = fn.instrs[id];
+        if (phi.op != IROp::Phi)
+            break;
+        for (size_t k = 0; k < phi.phi_blocks.size(); ++k)
+            if (phi.phi_blocks[k] == pred)
+            {
+                int arg = phi.args[k];
+                if (arg >= 0 && !(materialized(arg) && storage[arg] == storage[id]))
+                    copies.push_back({storage[id], arg});
+                break;
+            }
+    }
+    return copies;
+}
+
+// Умножение и деление на константу несут в value заранее посчитанный сдвиг или магическое число
+OPSElement IRLowering::binaryElement(const IRInstr &instr) const
+{
+    if (instr.bin != OPSCode::OP_MUL_POW2 && instr.bin != OPSCode::OP_DIV_CONST)
+        return OPSElement(instr.bin);
+    int constant = std::get<int>(fn.instrs[instr.args[1]].constant);
+    if (instr.bin == OPSCode::OP_DIV_CONST)
+        return OPSElement(instr.bin, divisionMagic(constant));
+    size_t shift = 0;
+    while ((1 << shift) != constant)
+        shift++;
+    return OPSElement(instr.bin, shift);
+}
+
+void IRLowering::emitValue(int id)
+{
+    const IRInstr &instr = fn.instrs[id];
+    if (instr.op == IROp::Const)
+    {
+        if (std::holds_alternative<int>(instr.constant))
+            emit(OPSElement(OPSCode::OP_INT_CONST, std::get<int>(instr.constant)));
+        else
+            emit(OPSElement(OPSCode::OP_FLOAT_CONST, std::get<float>(instr.constant)));
+    }
+    else if (inlined[id])
+    {
+        // Операнды относятся к той же инструкции, что и операция
+        emitFor(id);
+        emitValue(instr.args[0]);
+        emitValue(instr.args[1]);
+        emitFor(id);
+        emit(binaryElement(instr));
+    }
+    else
+        emit(OPSElement(OPSCode::OP_IDENT, storage[id]));
+}
+
+void IRLowering::emitRoot(int id)
+{
+    const IRInstr &instr = fn.instrs[id];
+    emitFor(id);
+    switch (instr.op)
+    {
+    case IROp::Binary:
+        emitValue(instr.args[0]);
+        emitValue(instr.args[1]);
+        emitFor(id);
+        emit(binaryElement(instr));
+        emit(OPSElement(OPSCode::OP_IDENT, storage[id]));
+        emit(OPSElement(OPSCode::OP_ASSIGN));
+        break;
+    case IROp::Read:
+        emit(OPSElement(OPSCode::OP_IDENT, storage[id]));
+        if (storage[id] == instr.var)
+            emit(OPSElement(OPSCode::OP_READ));
+        else
+            emit(OPSElement(OPSCode::OP_READ, instr.var)); // Приглашение с исходным именем
+        break;
+    case IROp::Print:
+    {
+        int arg = instr.args[0];
+        bool named_variable = materialized(arg) && storage[arg] == instr.var;
+        emitValue(arg);
+        emitFor(id);
+        if (named_variable || (!materialized(arg) && instr.var.empty()))
+            emit(OPSElement(OPSCode::OP_PRINT)); // Обычная форма: печать переменной или значения
+        else
+            emit(OPSElement(OPSCode::OP_PRINT, instr.var)); // Имя для печати задано явно ("" - без имени)
+        break;
+    }
+    default:
+        break; // Константы печатаются на месте, Phi стали присваиваниями
+    }
+}
+
+// Параллельные присваивания: сначала те, чья цель больше никем не читается; цикл разрывается временной
+void IRLowering::emitCopies(const std::vector<std::pair<std::string, int>> &copies)
+{
+    std::vector<std::pair<std::string, std::string>> moves; // (цель, источник) между переменными
+    std::vector<std::pair<std::string, int>> constants;
+    for (const auto &[target, value] : copies)
+    {
+        if (materialized(value))
+            moves.push_back({target, storage[value]});
+        else
+            constants.push_back({target, value});
+    }
+    while (!moves.empty())
+    {
+        size_t ready = moves.size();
+        for (size_t i = 0; i < moves.size() && ready == moves.size(); ++i)
+        {
+            bool read_later = false;
+            for (size_t j = 0; j < moves.size(); ++j)
+                if (j != i && moves[j].second == moves[i].first)
+                    read_later = true;
+            if (!read_later)
+                ready = i;
+        }
+        if (ready == moves.size())
+        {
+            // Цикл: сохраняем цель первого присваивания во временную
+            std::string saved = newTemp(), target = moves[0].first;
+            emit(OPSElement(OPSCode::OP_IDENT, target));
+            emit(OPSElement(OPSCode::OP_IDENT, saved));
+            emit(OPSElement(OPSCode::OP_ASSIGN));
+            for (auto &move : moves)
+                if (move.second == target)
+                    move.second = saved;
+            continue;
+        }
+        if (moves[ready].first != moves[ready].second)
+        {
+            emit(OPSElement(OPSCode::OP_IDENT, moves[ready].second));
+            emit(OPSElement(OPSCode::OP_IDENT, moves[ready].first));
+            emit(OPSElement(OPSCode::OP_ASSIGN));
+        }
+        moves.erase(moves.begin() + ready);
+    }
+    for (const auto &[target, value] : constants)
+    {
+        emitValue(value);
+        emit(OPSElement(OPSCode::OP_IDENT, target));
+        emit(OPSElement(OPSCode::OP_ASSIGN));
+    }
+}
+
+std::vector<OPSElement> IRLowering::run()
+{
+    splitCriticalEdges();
+    countUses();
+    chooseInlined();
+    assignStorage();
+
+    size_t block_count = fn.blocks.size();
+    std::vector<std::vector<std::pair<std::string, int>>> copies(block_count);
+    for (size_t b = 0; b < block_count; ++b)
+        if (!fn.blocks[b].removed && fn.blocks[b].term == IRTerm::Jump)
+            copies[b] = phiCopies(static_cast<int>(b), fn.blocks[b].succs[0]);
+
+    // Пустые блоки разрезанных рёбер прозрачны: переходы идут сразу к их цели
+    auto resolve = [&](int b)
+    {
+        while (is_edge_block[b] && copies[b].empty())
+            b = fn.blocks[b].succs[0];
+        return b;
+    };
+
+    // Размещение: порядок fn.layout, блок ребра "истина" сразу за условием (туда ведёт проход без перехода)
+    std::vector<int> layout;
+    std::vector<char> placed(block_count, 0);
+    std::vector<int> order = fn.layout;
+    for (size_t b = 0; b < block_count; ++b)
+        order.push_back(static_cast<int>(b)); // Блоки, которых нет в fn.layout, идут в конец
+    for (int b : order)
+    {
+        if (fn.blocks[b].removed || is_edge_block[b] || placed[b])
+            continue;
+        layout.push_back(b);
+        placed[b] = 1;
+        if (fn.blocks[b].term == IRTerm::Branch)
+        {
+            int t = fn.blocks[b].succs[0];
+            if (is_edge_block[t] && !copies[t].empty() && !placed[t])
+            {
+                layout.push_back(t);
+                placed[t] = 1;
+            }
+        }
+    }
+    for (size_t b = 0; b < block_count; ++b)
+        if (is_edge_block[b] && !copies[b].empty() && !placed[b])
+            layout.push_back(static_cast<int>(b));
+
+    // Метки нужны только блокам, на которые есть переход; выход в середине программы прыгает в конец
+    std::vector<std::string> label(block_count);
+    std::string end_label;
+    auto labelOf = [&](int b)
+    {
+        if (label[b].empty())
+            label[b] = newLabel();
+        return label[b];
+    };
+    auto jump = [&](const std::string &target, OPSCode code)
+    {
+        emit(OPSElement(OPSCode::OP_LABEL, target));
+        emit(OPSElement(code));
+    };
+
+    // Переход: проваливается та ветка, что идёт следующей; если это ложь - переход по истине (JT)
+    auto branch = [&](const BasicBlock &block, int next)
+    {
+        emitFor(block.cond);
+        emitValue(block.cond);
+        emitFor(block.cond);
+        int on_true = resolve(block.succs[0]), on_false = resolve(block.succs[1]);
+        if (on_false == next)
+            jump(labelOf(on_true), OPSCode::OP_JT);
+        else
+        {
+            jump(labelOf(on_false), OPSCode::OP_JF);
+            if (on_true != next)
+                jump(labelOf(on_true), OPSCode::OP_JMP);
+        }
+    };
+
+    // Поворот циклов: обратный переход на короткое условие цикла заменяется копией условия с переходом
+    // обратно в тело, так что итерация while выполняет один переход вместо JMP и JF (do-while).
+    // Копируется только вычисление условия, без ввода/вывода.
+    const size_t rotate_limit = 8;
+    std::vector<int> position(block_count, -1);
+    for (size_t i = 0; i < layout.size(); ++i)
+        position[layout[i]] = static_cast<int>(i);
+    auto rotatable = [&](int target, size_t at)
+    {
+        const BasicBlock &header = fn.blocks[target];
+        if (header.term != IRTerm::Branch || position[target] < 0 || static_cast<size_t>(position[target]) > at)
+            return false;
+        size_t size = 0;
+        for (int id : header.code)
+        {
+            IROp op = fn.instrs[id].op;
+            if (op == IROp::Read || op == IROp::Print)
+                return false;
+            if (op != IROp::Phi)
+                size++;
+        }
+        return size <= rotate_limit;
+    };
+
+    // Первый проход только раздаёт метки, второй выпускает код
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        ops.clear();
+        origins.clear();
+        current_origin = -1;
+        for (size_t i = 0; i < layout.size(); ++i)
+        {
+            int b = layout[i];
+            const BasicBlock &block = fn.blocks[b];
+            int next = i + 1 < layout.size() ? layout[i + 1] : -1;
+            if (!label[b].empty())
+                emit(OPSElement(OPSCode::OP_LABEL, label[b] + ":"));
+            for (int id : block.code)
+                if (!inlined[id])
+                    emitRoot(id);
+            switch (block.term)
+            {
+            case IRTerm::Exit:
+                if (next != -1)
+                {
+                    if (end_label.empty())
+                        end_label = newLabel();
+                    jump(end_label, OPSCode::OP_JMP);
+                }
+                break;
+            case IRTerm::Jump:
+            {
+                emitCopies(copies[b]);
+                int target = resolve(block.succs[0]);
+                if (target != next && rotatable(target, i))
+                {
+                    for (int id : fn.blocks[target].code)
+                        if (!inlined[id])
+                            emitRoot(id);
+                    branch(fn.blocks[target], next);
+                }
+                else if (target != next)
+                    jump(labelOf(target), OPSCode::OP_JMP);
+                break;
+            }
+            case IRTerm::Branch:
+                branch(block, next);
+                break;
+            }
+        }
+    }
+    if (!end_label.empty())
+        emit(OPSElement(OPSCode::OP_LABEL, end_label + ":"));
+    return ops;
+}
+
+std::vector<OPSElement> lowerIR(const IRFunction &fn, std::vector<int> *origins)
+{
+    IRLowering lowering(fn);
+    std::vector<OPSElement> ops = lowering.run();
+    if (origins)
+        *origins = lowering.elementOrigins();
+    return ops;
+}
+} // namespace translator::detail
@@ -0,0 +1,93 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <variant>
+#include "syntaxer.h"
+
+namespace translator::detail
+{
+// --- ПРОМЕЖУТОЧНОЕ ПРЕДСТАВЛЕНИЕ (IR) ---
+// ОПС режется на базовые блоки, из них строится граф потока управления (CFG),
+// переменные переводятся в SSA-форму. После оптимизаций IR опускается обратно в ОПС,
+// которую выполняет интерпретатор.
+
+enum class IROp
+{
+    Const,  // Константа (constant)
+    Load,   // Чтение переменной var (только до перевода в SSA)
+    Store,  // Запись args[0] в переменную var (только до перевода в SSA)
+    Binary, // Арифметика или сравнение bin над args[0], args[1]
+    Phi,    // Слияние: args[i] приходит из блока phi_blocks[i], -1 - значение не определено
+    Read,   // Ввод значения, var печатается в приглашении
+    Print   // Вывод args[0]; непустое var печатается как "value of var: "
+};
+
+// Номер инструкции в IRFunction::instrs одновременно является номером её значения (%N)
+struct IRInstr
+{
+    IROp op;
+    OPSCode bin;                  // Для Binary
+    std::vector<int> args;        // Номера инструкций-операндов
+    std::vector<int> phi_blocks;  // Для Phi: из какого блока приходит args[i]
+    std::variant<int, float> constant;
+    std::string var; // Переменная инструкции; для Binary и Phi - переменная, в которую значение попало (подсказка для хранения)
+    int origin;      // Индекс элемента исходной ОПС, из которого получена инструкция (для таблицы позиций), -1 - нет
+
+    IRInstr(IROp op) : op(op), bin(OPSCode::OP_ERROR), constant(0), origin(-1) {}
+};
+
+enum class IRTerm
+{
+    Exit,  // Конец программы
+    Jump,  // Безусловный переход на succs[0]
+    Branch // Условие cond: истина - succs[0], ложь - succs[1]
+};
+
+struct BasicBlock
+{
+    std::vector<int> code; // Инструкции по порядку, Phi всегда в начале
+    IRTerm term;
+    int cond;
+    std::vector<int> succs;
+    std::vector<int> preds;
+    bool removed; // Блок недостижим и выброшен
+
+    BasicBlock() : term(IRTerm::Exit), cond(-1), removed(false) {}
+};
+
+class IRFunction
+{
+public:
+    std::vector<IRInstr> instrs;
+    std::vector<BasicBlock> blocks; // blocks[0] - вход
+    std::vector<int> layout;        // Порядок размещения блоков при опускании в ОПС
+    bool ssa;
+
+    IRFunction() : ssa(false) {}
+
+    int add(const IRInstr &instr)
+    {
+        instrs.push_back(instr);
+        return static_cast<int>(instrs.size()) - 1;
+    }
+    int addBlock()
+    {
+        blocks.emplace_back();
+        return static_cast<int>(blocks.size()) - 1;
+    }
+
+    void computePreds();
+    void removeUnreachable();
+    std::vector<int> reversePostOrder() const;
+    std::vector<int> immediateDominators(const std::vector<int> &rpo) const;
+    void dump(std::ostream &out, const std::string &title) const;
+};
+
+// Построение CFG по ОПС; false, если ОПС не укладывается в схему блоков
+bool buildIR(const std::vector<OPSElement> &ops_code, IRFunction &fn);
+// Перевод CFG в SSA-форму
+bool constructSSA(IRFunction &fn);
+// origins (если задан) получает для каждого элемента новой ОПС индекс элемента исходной ОПС, -1 - неизвестно
+std::vector<OPSElement> lowerIR(const IRFunction &fn, std::vector<int> *origins = nullptr);
+} // namespace translator::detail
@@ -0,0 +1,96 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <functional>
+
+namespace translator::detail
+{
+using namespace std;
+
+enum TokenType
+{
+    ID,          // Идентификатор
+    INT_CONST,   // Целочисленная константа
+    FLOAT_CONST, // Вещественная константа
+    OPERATOR,    // Оператор
+    DELIMITER,   // Разделитель
+    KEYWORD,     // Ключевое слово
+    TOKEN_EOF
+};
+
+struct Token
+{
+    TokenType type;
+    string str_;
+    int int_;
+    float flo_;
+    size_t row;    // Позиция начала лексемы в тексте (с нуля)
+    size_t column;
+    Token() : type(ID), str_(""), int_(0), flo_(0), row(0), column(0) {}
+    Token(TokenType t, const string &v) : type(t), str_(v), int_(0), flo_(0), row(0), column(0) {}
+    Token(TokenType t, const int &v) : type(t), str_(""), int_(v), flo_(0), row(0), column(0) {}
+    Token(TokenType t, const float &v) : type(t), str_(""), int_(0), flo_(v), row(0), column(0) {}
+};
+
+enum State
+{
+    START,  // Начальное состояние
+    IDENT,  // Идентификатор
+    INT,    // Целое число
+    DOT,    // Точка в числе
+    FLOAT,  // Вещественное число
+    LES,    // Меньше ("<")
+    GRT,    // Больше (">")
+    EQU,    // Равно ("=")
+    Z,      // Лексема распознана
+    Z_STAR, // Лексема распознана с откатом
+    ERR     // Ошибка
+};
+
+class Lexer
+{
+private:
+    // Входной текст
+    string input;
+    size_t pos;          // Текущая позиция в тексте
+    // Текст из потока (--stream): input - очередной блок, pos - позиция в нём
+    istream *source = nullptr;
+    function<void()> before_block; // Вызывается перед чтением следующего блока
+    bool source_ended = false;
+    char last_read = '\n';         // Последний прочитанный символ: в конце потока дописывается '\n', как в convert()
+    static const size_t block_size = 1 << 16;
+    State current_state; // Текущее состояние, выделил потому чтобы кучу раз во все функции не передавать аргументом.
+    char currentChar;    // Текущий символ
+    size_t row;
+    size_t column;
+    size_t token_row; // Где началась текущая лексема
+    size_t token_column;
+    string name;
+    int num;
+    float flo;
+    string op;
+    float d = 1;
+
+    // Вспомогательные функции
+    void advance();        // Переход к следующему символу
+    State nextState(char); // Определение следующего состояния
+    Token makeToken();     // Создание токена
+    void Programs(int);
+    void refill();         // Следующий блок из source
+
+public:
+    Lexer(const string &text); // Конструктор
+    // Кусок текста, который в файле начинается со строки row и столбца column (с нуля): позиции лексем и ошибок - как у файла
+    Lexer(string text, size_t row, size_t column);
+    // Текст читается из source блоками по мере разбора, целиком в памяти не держится
+    Lexer(istream &source, function<void()> before_block = nullptr);
+    Lexer();
+    Token getNextToken(); // Получение следующего токена
+    size_t get_pos();
+    size_t get_row();
+    size_t get_column();
+    string get_input();
+};
+
+string convert(string filename); // Файл одной строкой, как его ждёт лексер: строки с '\n' и завершающий '\0'
+} // namespace translator::detail
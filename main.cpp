@@ -0,0 +1,664 @@
+// --- КОМАНДНАЯ СТРОКА ---
+// Точка входа программы interpreter: разбор, печать ОПС, выполнение с вводом-выводом через stdin/stdout.
+// Встраиваемая библиотека с тем же конвейером - translator.h / translator.cpp.
+#include <thread> // Для пакетного прогона по потокам
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <fcntl.h> // Для open
+#include <sys/stat.h> // Для stat (--watch)
+#include <fstream>
+#include "interpreter.h"
+#include "fragments.h"
+#include "stats.h"
+using namespace std;
+using namespace translator::detail;
+// --- ПАКЕТНЫЙ ПРОГОН (--records) ---
+// Программа компилируется один раз и выполняется для каждой строки файла записей: значения строки,
+// разделённые запятыми или пробелами, уходят в её read(). Записи раздаются потокам кусками, у каждого потока
+// свой Interpreter, а ОПС общая и только читается. Вывод записи собирается в строку и печатается в порядке записей,
+// как только готов её кусок и все предыдущие.
+struct BatchRecord
+{
+    size_t begin, end; // Строка записи в тексте файла
+    string output;     // Что напечатала программа
+    string error;      // Ошибка выполнения, если была
+    bool limited;      // Остановлена по --max-instructions / --max-time
+};
+
+// Итог пакетного прогона: сколько записей остановилось ошибкой, из них - по ограничению
+struct BatchResult
+{
+    size_t failed = 0;
+    size_t limited = 0;
+};
+
+const size_t batch_chunk = 256; // Записей, которые поток берёт за раз
+
+// limits действуют на каждую запись отдельно; profile (если задан) получает сумму профилей всех потоков
+BatchResult runBatch(const vector<OPSElement> &ops_code, const string &records_text, unsigned threads, FloatFormat format,
+                const RunLimits &limits, ExecutionProfile *profile, ostream &out)
+{
+    vector<BatchRecord> records;
+    for (size_t pos = 0; pos < records_text.size();)
+    {
+        size_t eol = records_text.find('\n', pos);
+        if (eol == string::npos)
+            eol = records_text.size();
+        records.push_back({pos, eol, string(), string(), false});
+        pos = eol + 1;
+    }
+    size_t chunks = (records.size() + batch_chunk - 1) / batch_chunk;
+    atomic<size_t> next_chunk(0);
+    vector<char> chunk_done(chunks, 0);
+    mutex done_mutex;
+    condition_variable done_cv;
+    mutex profile_mutex;
+
+    auto worker = [&]()
+    {
+        Interpreter inter(ops_code);
+        ExecutionProfile worker_profile;
+        if (profile)
+            inter.collectProfile(&worker_profile);
+        string text; // Вывод текущей записи, затем он обменивается с record.output
+        OutputBuffer output(text, format);
+        for (size_t chunk; (chunk = next_chunk.fetch_add(1)) < chunks;)
+        {
+            size_t last = min(records.size(), (chunk + 1) * batch_chunk);
+            for (size_t r = chunk * batch_chunk; r < last; ++r)
+            {
+                BatchRecord &record = records[r];
+                InputReader input(records_text.data() + record.begin, records_text.data() + record.end, r + 1, ',');
+                StreamIO io(output, input);
+                inter.start(io, limits);
+                RunStatus status = inter.resume(0);
+                if (status != RunStatus::Finished)
+                {
+                    record.error = inter.error();
+                    record.limited = status == RunStatus::LimitExceeded;
+                }
+                record.output.swap(text);
+            }
+            {
+                lock_guard<mutex> lock(done_mutex);
+                chunk_done[chunk] = 1;
+            }
+            done_cv.notify_one();
+        }
+        if (profile)
+        {
+            lock_guard<mutex> lock(profile_mutex);
+            profile->merge(worker_profile);
+        }
+    };
+    vector<thread> pool;
+    for (unsigned t = 0; t < max(1u, threads) && t < chunks; ++t)
+        pool.emplace_back(worker);
+
+    // Печать по порядку, пока потоки считают следующие куски
+    BatchResult result;
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        {
+            unique_lock<mutex> lock(done_mutex);
+            done_cv.wait(lock, [&]() { return chunk_done[chunk] != 0; });
+        }
+        size_t last = min(records.size(), (chunk + 1) * batch_chunk);
+        for (size_t r = chunk * batch_chunk; r < last; ++r)
+        {
+            BatchRecord &record = records[r];
+            out.write(record.output.data(), static_cast<streamsize>(record.output.size()));
+            if (!record.error.empty())
+            {
+                ++result.failed;
+                if (record.limited)
+                    ++result.limited;
+                out.flush();
+                cerr << "Record " << r + 1 << ": " << record.error << endl;
+            }
+            string().swap(record.output); // Напечатанное больше не нужно
+        }
+    }
+    for (thread &t : pool)
+        t.join();
+    out.flush();
+    return result;
+}
+
+// --- ПОТОКОВОЕ ВЫПОЛНЕНИЕ (--stream) ---
+// Файл не читается целиком и ОПС всей программы не строится: лексер берёт текст блоками, парсер отдаёт по одному
+// оператору верхнего уровня, интерпретатор сразу выполняет его ОПС, и она выбрасывается. Память и время до первого
+// вывода ограничены самым большим оператором (целый while или if с телом), а не размером файла.
+// Переходы не выходят за оператор верхнего уровня, поэтому метки разрешаются в его ОПС; переменные остаются
+// в интерпретаторе между операторами. Отличия от обычного режима: текст и ОПС не печатаются; ошибка в середине
+// файла обнаруживается, когда операторы до неё уже выполнены (оператор с ошибкой не выполняется); формат
+// вещественных (fixed с двумя знаками) включается с первого оператора с вещественной константой, а не для всей программы.
+// Возвращает код выхода, как main.
+int runStream(istream &source, OutputBuffer &output, InputReader &input, const RunLimits &limits, RunStats &stats)
+{
+    StreamIO io(output, input);
+    vector<OPSElement> ops_code; // ОПС текущего оператора
+    Lexer lexer(source, [&output]() { output.flush(); }); // Пока читается следующий блок, напечатанное уже видно
+    Interpreter inter(ops_code);
+    inter.trackStackDepth(stats.on());
+    inter.start(io, limits);
+    bool fixed = false;
+    size_t statements = 0, largest = 0;
+    RunStatus status = RunStatus::Finished;
+    int code = 0;
+    stats.begin("stream");
+    try
+    {
+        Parser parser(lexer, ops_code, cout, cerr);
+        while (parser.parseStatement())
+        {
+            if (parser.hasSemanticErrors())
+                break;
+            ++statements;
+            largest = max(largest, ops_code.size());
+            if (!fixed && printFormatOf(ops_code).format == chars_format::fixed)
+            {
+                fixed = true;
+                output.setFloatFormat(printFormatOf(ops_code));
+            }
+            inter.reload();
+            status = inter.resume(0);
+            ops_code.clear();
+            if (status != RunStatus::Finished)
+            {
+                output.flush();
+                cerr << inter.error() << endl;
+                break;
+            }
+        }
+        if (parser.hasSyntaxError())
+            cerr << "Parsing failed: Syntax errors found." << endl;
+        else if (parser.hasSemanticErrors())
+            cerr << "Semantic analysis failed: variables used before definition." << endl;
+        if (parser.hasSyntaxError() || parser.hasSemanticErrors())
+            code = 1;
+    }
+    catch (const runtime_error &e)
+    {
+        output.flush();
+        cout << e.what(); // Лексическая ошибка
+        code = -1;
+    }
+    output.flush();
+    stats.end();
+    stats.count("statements", statements);
+    stats.count("largest_statement_ops", largest);
+    stats.count("instructions", inter.instructions());
+    stats.count("peak_stack", inter.peakStack());
+    stats.count("variables", inter.variables());
+    if (code == 0 && status == RunStatus::LimitExceeded)
+        code = 2;
+    return code;
+}
+
+// --- НАБЛЮДЕНИЕ ЗА ФАЙЛОМ (--watch) ---
+// Файл перекомпилируется после каждого сохранения, и программа выполняется заново. Сохранение замечается по времени
+// изменения, размеру и inode (опрос раз в watch_interval). IncrementalCompiler разбирает заново только операторы
+// верхнего уровня, задетые правкой, поэтому после правки большого файла компиляция - миллисекунды, а не полный разбор.
+// Текст и ОПС не печатаются; после компиляции в stderr - сколько операторов разобрано и за сколько. Ввод для read()
+// по --input открывается заново на каждый запуск. Работает, пока процесс не остановят.
+const chrono::milliseconds watch_interval(50);
+
+void watchFile(const string &filename, bool optimize, const OptimizerOptions &options, int output_fd, bool batch,
+               const string &input_file, const RunLimits &limits, unsigned compile_threads)
+{
+    IncrementalCompiler compiler(compile_threads);
+    struct stat seen = {};
+    bool missing_reported = false;
+    for (;; this_thread::sleep_for(watch_interval))
+    {
+        struct stat info;
+        if (stat(filename.c_str(), &info) != 0)
+        {
+            if (!missing_reported)
+                cerr << "The file for reading was not found in the directory." << endl;
+            missing_reported = true;
+            continue;
+        }
+        missing_reported = false;
+        if (info.st_mtim.tv_sec == seen.st_mtim.tv_sec && info.st_mtim.tv_nsec == seen.st_mtim.tv_nsec &&
+            info.st_size == seen.st_size && info.st_ino == seen.st_ino)
+            continue;
+        seen = info;
+        string text = convert(filename);
+        if (text == "NULL")
+            continue; // Файл успели удалить или переименовать - подождём следующего сохранения
+
+        auto started = chrono::steady_clock::now();
+        bool ok;
+        try
+        {
+            ok = compiler.compile(move(text), cout, cerr);
+        }
+        catch (const runtime_error &e)
+        {
+            cout << e.what(); // Лексическая ошибка
+            ok = false;
+        }
+        cerr << "--- " << filename << ": " << compiler.parsedStatements() << " of " << compiler.totalStatements()
+             << " statements parsed in " << chrono::duration<double, milli>(chrono::steady_clock::now() - started).count()
+             << " ms ---" << endl;
+        if (!ok)
+            continue;
+
+        const vector<OPSElement> *program = &compiler.program();
+        FloatFormat format = printFormatOf(*program); // Как после printOPS в обычном режиме - по ОПС до оптимизации
+        vector<OPSElement> optimized;
+        if (optimize)
+        {
+            optimized = *program;
+            optimizeOPS(optimized, options);
+            program = &optimized;
+        }
+        int input_fd = 0; // stdin
+        if (!input_file.empty() && (input_fd = open(input_file.c_str(), O_RDONLY)) < 0)
+        {
+            cerr << "The input file was not found: " << input_file << endl;
+            continue;
+        }
+        cout << "--- Inter running... ---" << endl;
+        OutputBuffer output = output_fd >= 0 ? OutputBuffer(output_fd) : OutputBuffer(cout);
+        output.setFloatFormat(format);
+        InputReader input = batch ? InputReader(input_fd, !input_file.empty()) : InputReader(cin);
+        StreamIO io(output, input);
+        Interpreter inter(*program);
+        bool finished = inter.run(io, limits);
+        output.flush();
+        if (!finished)
+            cerr << inter.error() << endl;
+    }
+}
+
+// --- Главная функция программы ---
+int main(int argc, char *argv[])
+{
+    string filename = "test.txt"; // Укажите правильный путь к файлу
+    bool optimize = false;        // -O: прогнать ОПС через IR
+    OptimizerOptions options;
+    int output_fd = -1;           // --output-fd=N: вывод программы прямо в дескриптор N, мимо cout
+    bool batch = false;           // --batch: read() без приглашений, stdin читается блоками
+    string input_file;            // --input=FILE: значения для read() из файла (включает --batch)
+    string records_file;          // --records=FILE: выполнить программу для каждой строки FILE
+    unsigned threads = thread::hardware_concurrency(); // --threads=N: потоков пакетного прогона
+    unsigned compile_threads = 1; // --compile-threads=N: разбирать текст кусками на N потоках
+    RunLimits limits;             // --max-instructions=N, --max-time=MS: остановить зациклившуюся программу
+    bool profiling = false;       // --profile: отчёт профилировщика в stderr после выполнения
+    string folded_file;           // --profile-folded=FILE: свёрнутые стеки для flamegraph (включает --profile)
+    bool stats_text = false;      // --stats: время, выделения памяти и счётчики по этапам в stderr
+    string stats_file;            // --stats-json=FILE: то же в JSON
+    string record_file;           // --record=FILE: записать ввод и исходы переходов
+    string replay_file;           // --replay=FILE: выполнить с вводом из трассы и сверить переходы
+    string snapshot_file;         // --snapshot=FILE: снимок состояния после --snapshot-after=N инструкций
+    size_t snapshot_after = 0;
+    string restore_file;          // --restore=FILE: продолжить с места снимка
+    bool streaming = false;       // --stream: выполнять операторы верхнего уровня по мере разбора
+    bool watching = false;        // --watch: перекомпилировать и выполнять заново после каждого сохранения файла
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "-O")
+            optimize = true;
+        else if (arg == "--dump-ir")
+            optimize = options.dump_ir = true; // включает -O
+        else if (arg.compare(0, 9, "--unroll=") == 0)
+            options.unroll_factor = atoi(arg.c_str() + 9);
+        else if (arg.compare(0, 12, "--output-fd=") == 0)
+            output_fd = atoi(arg.c_str() + 12);
+        else if (arg == "--batch")
+            batch = true;
+        else if (arg.compare(0, 10, "--records=") == 0)
+            records_file = arg.substr(10);
+        else if (arg.compare(0, 10, "--threads=") == 0)
+            threads = static_cast<unsigned>(atoi(arg.c_str() + 10));
+        else if (arg.compare(0, 18, "--compile-threads=") == 0)
+        {
+            compile_threads = static_cast<unsigned>(atoi(arg.c_str() + 18));
+            if (compile_threads == 0)
+                compile_threads = max(1u, thread::hardware_concurrency());
+        }
+        else if (arg.compare(0, 19, "--max-instructions=") == 0)
+            limits.max_instructions = static_cast<size_t>(atoll(arg.c_str() + 19));
+        else if (arg.compare(0, 11, "--max-time=") == 0)
+            limits.max_time = chrono::milliseconds(atoll(arg.c_str() + 11));
+        else if (arg == "--profile")
+            profiling = true;
+        else if (arg.compare(0, 17, "--profile-folded=") == 0)
+        {
+            folded_file = arg.substr(17);
+            profiling = true;
+        }
+        else if (arg == "--stats")
+            stats_text = true;
+        else if (arg.compare(0, 13, "--stats-json=") == 0)
+            stats_file = arg.substr(13);
+        else if (arg.compare(0, 9, "--record=") == 0)
+            record_file = arg.substr(9);
+        else if (arg.compare(0, 9, "--replay=") == 0)
+            replay_file = arg.substr(9);
+        else if (arg.compare(0, 11, "--snapshot=") == 0)
+            snapshot_file = arg.substr(11);
+        else if (arg.compare(0, 17, "--snapshot-after=") == 0)
+            snapshot_after = static_cast<size_t>(atoll(arg.c_str() + 17));
+        else if (arg.compare(0, 10, "--restore=") == 0)
+            restore_file = arg.substr(10);
+        else if (arg == "--stream")
+            streaming = true;
+        else if (arg == "--watch")
+            watching = true;
+        else if (arg.compare(0, 8, "--input=") == 0)
+        {
+            input_file = arg.substr(8);
+            batch = true;
+        }
+        else
+            filename = arg;
+    }
+
+    if ((!record_file.empty() || !replay_file.empty()) && !records_file.empty())
+    {
+        cerr << "--record and --replay work with a single run, not with --records." << endl;
+        return 1;
+    }
+    if ((!snapshot_file.empty() || !restore_file.empty()) && !records_file.empty())
+    {
+        cerr << "--snapshot and --restore work with a single run, not with --records." << endl;
+        return 1;
+    }
+    if (!snapshot_file.empty() && snapshot_after == 0)
+    {
+        cerr << "--snapshot needs --snapshot-after=N: after how many instructions to take it." << endl;
+        return 1;
+    }
+    if (!restore_file.empty() && (!record_file.empty() || !replay_file.empty()))
+    {
+        cerr << "--restore cannot be combined with --record or --replay: a trace starts from the beginning." << endl;
+        return 1;
+    }
+    if (streaming && (optimize || profiling || !records_file.empty() || !record_file.empty() || !replay_file.empty() ||
+                      !snapshot_file.empty() || !restore_file.empty()))
+    {
+        cerr << "--stream executes statements as they are parsed and cannot be combined with -O, --profile, --records, "
+                "--record, --replay, --snapshot or --restore." << endl;
+        return 1;
+    }
+    if (watching && (streaming || profiling || stats_text || !stats_file.empty() || !records_file.empty() || !record_file.empty() ||
+                     !replay_file.empty() || !snapshot_file.empty() || !restore_file.empty()))
+    {
+        cerr << "--watch reruns the program after every save and cannot be combined with --stream, --profile, --stats, "
+                "--records, --record, --replay, --snapshot or --restore." << endl;
+        return 1;
+    }
+    if (watching)
+    {
+        watchFile(filename, optimize, options, output_fd, batch, input_file, limits, compile_threads);
+        return 0;
+    }
+    InterpreterState restored;
+    if (!restore_file.empty())
+    {
+        string snapshot_error;
+        if (!restored.load(restore_file, snapshot_error))
+        {
+            cerr << snapshot_error << endl;
+            return 1;
+        }
+    }
+    ExecutionTrace trace;
+    if (!replay_file.empty())
+    {
+        string trace_error;
+        if (!trace.load(replay_file, trace_error))
+        {
+            cerr << trace_error << endl;
+            return 1;
+        }
+    }
+
+    RunStats stats(stats_text || !stats_file.empty());
+    int input_fd = 0; // stdin
+    if (!input_file.empty() && (input_fd = open(input_file.c_str(), O_RDONLY)) < 0)
+    {
+        cerr << "The input file was not found: " << input_file << endl;
+        return 1;
+    }
+    auto writeStats = [&]()
+    {
+        if (stats_text)
+            stats.writeText(cerr);
+        if (!stats_file.empty())
+        {
+            ofstream json(stats_file);
+            stats.writeJson(json);
+            if (!json)
+                cerr << "Cannot write " << stats_file << endl;
+        }
+    };
+    if (streaming)
+    {
+        ifstream source(filename, ios::binary);
+        if (!source)
+        {
+            cerr << "The file for reading was not found in the directory." << endl;
+            return 1;
+        }
+        OutputBuffer output = output_fd >= 0 ? OutputBuffer(output_fd) : OutputBuffer(cout);
+        InputReader input = batch ? InputReader(input_fd, !input_file.empty()) : InputReader(cin);
+        int code = runStream(source, output, input, limits, stats);
+        writeStats();
+        return code;
+    }
+    stats.begin("read");
+    string text = convert(filename);
+    stats.end();
+    if (text == "NULL")
+    {
+        cerr << "The file for reading was not found in the directory." << endl;
+        return 1;
+    }
+    string records_text;
+    if (!records_file.empty())
+    {
+        ifstream records_in(records_file, ios::binary);
+        if (!records_in)
+        {
+            cerr << "The records file was not found: " << records_file << endl;
+            return 1;
+        }
+        records_in.seekg(0, ios::end);
+        records_text.resize(static_cast<size_t>(records_in.tellg()));
+        records_in.seekg(0);
+        records_in.read(&records_text[0], static_cast<streamsize>(records_text.size()));
+    }
+    cout << text;
+    if (stats.on())
+    {
+        // Лексер отдельным проходом: парсер запрашивает лексемы по одной, и его время включает лексер
+        stats.begin("lex");
+        size_t tokens = 0;
+        try
+        {
+            Lexer counter(text);
+            while (counter.getNextToken().type != TOKEN_EOF)
+                ++tokens;
+        }
+        catch (const runtime_error &)
+        {
+            // Лексическую ошибку сообщит парсер
+        }
+        stats.end();
+        stats.count("tokens", tokens);
+    }
+    vector<OPSElement> ops_code;
+    vector<SourcePosition> positions; // Строка и столбец каждого элемента ОПС - только для профиля
+    try
+    {
+        if (compile_threads > 1)
+        {
+            stats.begin("parse");
+            bool parsed = parseParallel(text, ops_code, profiling ? &positions : nullptr, compile_threads, cout, cerr);
+            stats.end();
+            if (!parsed)
+                return 1;
+        }
+        else
+        {
+            // Создаем лексер с текстом из файла
+            Lexer lexer(text);
+            // Создаем парсер, передавая ему лексер
+            Parser parser(lexer, ops_code, cout, cerr, profiling ? &positions : nullptr);
+
+            // Запускаем процесс парсинга
+            stats.begin("parse");
+            parser.parse();
+            stats.end();
+            if (parser.hasSyntaxError() || parser.hasSemanticErrors())
+                return 1; // Возвращаем ненулевой код для ошибки синтаксиса
+        }
+    }
+    catch (const runtime_error &e)
+    {
+        cout << e.what(); // Лексическая ошибка
+        return -1;
+    }
+
+    // Печатаем сгенерированную ОПС: ОПС выполняется только если нет ни синтаксических ошибок, ни переменных без значения
+    if (optimize)
+    {
+        printOPS(ops_code);
+        if (profiling)
+            options.positions = &positions;
+        stats.begin("optimize");
+        optimizeOPS(ops_code, options);
+        stats.end();
+    }
+    stats.begin("print");
+    printOPS(ops_code);
+    stats.end();
+    if (stats.on())
+    {
+        stats.count("ops", ops_code.size());
+        stats.count("labels", static_cast<size_t>(count_if(ops_code.begin(), ops_code.end(), [](const OPSElement &element)
+                                                          { return element.code == OPSCode::OP_LABEL; })));
+    }
+    if (!replay_file.empty() && trace.program_hash != programHash(ops_code))
+    {
+        cerr << "The trace was recorded for a different program (or with other -O / --unroll)." << endl;
+        return 1;
+    }
+    if (!restore_file.empty() && restored.program_hash != programHash(ops_code))
+    {
+        cerr << "The snapshot was taken from a different program (or with other -O / --unroll)." << endl;
+        return 1;
+    }
+    cout << endl
+         << "--- Inter running... ---" << endl;
+    // Буфер создаётся после printOPS: он перенимает у cout формат вещественных чисел
+    ExecutionProfile profile;
+    RunStatus status = RunStatus::Finished;
+    bool replay_diverged = false;
+    if (!records_file.empty())
+    {
+        stats.begin("run");
+        BatchResult batch_result = runBatch(ops_code, records_text, threads, floatFormatOf(cout), limits,
+                                            profiling ? &profile : nullptr, cout);
+        stats.end();
+        if (batch_result.limited > 0)
+            status = RunStatus::LimitExceeded; // Код выхода 2, как у одиночного запуска
+    }
+    else
+    {
+        OutputBuffer output = output_fd >= 0 ? OutputBuffer(output_fd) : OutputBuffer(cout);
+        InputReader input = batch ? InputReader(input_fd, !input_file.empty()) : InputReader(cin);
+        StreamIO stream_io(output, input);
+        TraceIO trace_io(stream_io, trace);
+        bool tracing = !record_file.empty() || !replay_file.empty();
+        RuntimeIO &io = tracing ? static_cast<RuntimeIO &>(trace_io) : stream_io;
+        stats.begin("labels");
+        Interpreter inter(ops_code); // Конструктор разрешает метки
+        stats.end();
+        if (profiling)
+            inter.collectProfile(&profile);
+        inter.trackStackDepth(stats.on());
+        if (tracing)
+            inter.traceBranches(&trace);
+        stats.begin("run");
+        if (restore_file.empty())
+            inter.start(io, limits);
+        else if (!inter.restore(io, restored, limits))
+        {
+            cerr << "The snapshot does not fit the program: " << restore_file << endl;
+            return 1;
+        }
+        if (!snapshot_file.empty())
+        {
+            // Первые snapshot_after инструкций, снимок, затем выполнение до конца
+            status = inter.resume(snapshot_after);
+            if (status == RunStatus::Yielded)
+            {
+                InterpreterState state = inter.state();
+                state.program_hash = programHash(ops_code);
+                if (!state.save(snapshot_file))
+                    cerr << "Cannot write " << snapshot_file << endl;
+                status = inter.resume(0);
+            }
+            else
+                cerr << "The program stopped before " << snapshot_after << " instructions, no snapshot taken." << endl;
+        }
+        else
+            status = inter.resume(0);
+        stats.end();
+        if (status != RunStatus::Finished)
+            cerr << inter.error() << endl;
+        stats.count("instructions", inter.instructions());
+        stats.count("peak_stack", inter.peakStack());
+        stats.count("variables", inter.variables());
+        if (!record_file.empty())
+        {
+            trace.program_hash = programHash(ops_code);
+            trace.instructions = inter.instructions();
+            if (!trace.save(record_file))
+                cerr << "Cannot write " << record_file << endl;
+        }
+        if (!replay_file.empty())
+        {
+            // Ошибка или ограничение тоже воспроизводятся: сравнивается, докуда дошло выполнение
+            if (inter.instructions() != trace.instructions || trace.next_branch != trace.branch_count ||
+                trace.next_input != trace.inputs.size())
+            {
+                cerr << "Replay Error: " << inter.instructions() << " instructions, " << trace.next_branch << " branches, "
+                     << trace.next_input << " inputs; the trace has " << trace.instructions << ", " << trace.branch_count
+                     << " and " << trace.inputs.size() << "." << endl;
+                replay_diverged = true;
+            }
+            else
+                cerr << "Replay matches the trace: " << trace.instructions << " instructions, " << trace.branch_count
+                     << " branches, " << trace.inputs.size() << " inputs." << endl;
+        }
+    }
+    writeStats();
+    if (profiling)
+    {
+        writeProfileReport(cerr, ops_code, positions, profile);
+        if (!folded_file.empty())
+        {
+            // Имя программы - корень стеков; ';' и пробел в нём сломали бы формат
+            string program = filename.substr(filename.find_last_of('/') + 1);
+            replace(program.begin(), program.end(), ';', '_');
+            replace(program.begin(), program.end(), ' ', '_');
+            ofstream folded(folded_file);
+            writeFoldedStacks(folded, program, ops_code, positions, profile);
+            if (!folded)
+                cerr << "Cannot write " << folded_file << endl;
+        }
+    }
+    if (status == RunStatus::LimitExceeded)
+        return 2;
+    return replay_diverged ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+#include "metrics.h"
+
+const char *const runtime_error_kind_names[] = {"division_by_zero", "input_ended", "invalid_input", "stack_underflow",
+                                                "undefined_label", "limit", "internal", "other"};
+
+RuntimeErrorKind runtimeErrorKind(const std::string &message)
+{
+    if (message.find("Division by zero") != std::string::npos)
+        return RuntimeErrorKind::DivisionByZero;
+    if (message.find("Input ended") != std::string::npos)
+        return RuntimeErrorKind::InputEnded;
+    if (message.find("Invalid input") != std::string::npos)
+        return RuntimeErrorKind::InvalidInput;
+    if (message.find("Stack underflow") != std::string::npos)
+        return RuntimeErrorKind::StackUnderflow;
+    if (message.find("Undefined label") != std::string::npos)
+        return RuntimeErrorKind::UndefinedLabel;
+    if (message.compare(0, 12, "Limit Error:") == 0)
+        return RuntimeErrorKind::Limit;
+    if (message.compare(0, 8, "Internal") == 0)
+        return RuntimeErrorKind::Internal;
+    return RuntimeErrorKind::Other;
+}
+
+std::string MetricsRegistry::scrape() const
+{
+    uint64_t metrics[metric_count] = {};
+    uint64_t errors[error_kind_count] = {};
+    uint64_t buckets[run_seconds_bucket_count + 1] = {};
+    uint64_t run_nanoseconds = 0;
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        for (const auto &shard : shards)
+        {
+            for (size_t i = 0; i < metric_count; ++i)
+                metrics[i] += shard->metrics[i].load(std::memory_order_relaxed);
+            for (size_t i = 0; i < error_kind_count; ++i)
+                errors[i] += shard->errors[i].load(std::memory_order_relaxed);
+            for (size_t i = 0; i <= run_seconds_bucket_count; ++i)
+                buckets[i] += shard->buckets[i].load(std::memory_order_relaxed);
+            run_nanoseconds += shard->run_nanoseconds.load(std::memory_order_relaxed);
+        }
+    }
+    auto value = [&](Metric metric) { return std::to_string(metrics[static_cast<size_t>(metric)]); };
+    std::string text;
+    auto counter = [&](const char *name, const char *help, const std::string &lines)
+    { text += std::string("# HELP ") + name + " " + help + "\n# TYPE " + name + " counter\n" + lines; };
+
+    counter("translator_scripts_compiled_total", "Programs compiled successfully.",
+            "translator_scripts_compiled_total " + value(Metric::ScriptsCompiled) + "\n");
+    counter("translator_compile_errors_total", "Programs rejected by the lexer or parser.",
+            "translator_compile_errors_total " + value(Metric::CompileErrors) + "\n");
+    counter("translator_compile_cache_hits_total", "Programs taken from the compile cache.",
+            "translator_compile_cache_hits_total " + value(Metric::CacheHits) + "\n");
+    counter("translator_compile_cache_misses_total", "Programs not found in the compile cache.",
+            "translator_compile_cache_misses_total " + value(Metric::CacheMisses) + "\n");
+    counter("translator_instructions_total", "OPS instructions executed.",
+            "translator_instructions_total " + value(Metric::Instructions) + "\n");
+    counter("translator_input_bytes_total", "Request bytes received: program text and read() values.",
+            "translator_input_bytes_total " + value(Metric::InputBytes) + "\n");
+    counter("translator_output_bytes_total", "Response bytes sent.",
+            "translator_output_bytes_total " + value(Metric::OutputBytes) + "\n");
+    counter("translator_scripts_finished_total", "Programs answered, by response status.",
+            "translator_scripts_finished_total{status=\"ok\"} " + value(Metric::FinishedOk) + "\n" +
+                "translator_scripts_finished_total{status=\"error\"} " + value(Metric::FinishedError) + "\n" +
+                "translator_scripts_finished_total{status=\"compile-error\"} " + value(Metric::FinishedCompileError) + "\n" +
+                "translator_scripts_finished_total{status=\"limit\"} " + value(Metric::FinishedLimit) + "\n");
+    std::string lines;
+    for (size_t i = 0; i < error_kind_count; ++i)
+        lines += std::string("translator_runtime_errors_total{kind=\"") + runtime_error_kind_names[i] + "\"} " +
+                 std::to_string(errors[i]) + "\n";
+    counter("translator_runtime_errors_total", "Programs stopped by a runtime error, by kind.", lines);
+
+    text += "# HELP translator_script_run_seconds Time a program spent executing on the pool, input waits excluded.\n"
+            "# TYPE translator_script_run_seconds histogram\n";
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= run_seconds_bucket_count; ++i)
+    {
+        cumulative += buckets[i];
+        std::string bound = i < run_seconds_bucket_count ? std::to_string(run_seconds_buckets[i]) : "+Inf";
+        if (i < run_seconds_bucket_count)
+            bound.erase(bound.find_last_not_of('0') + 1).erase(bound.find_last_not_of('.') + 1); // 0.100000 -> 0.1
+        text += "translator_script_run_seconds_bucket{le=\"" + bound + "\"} " + std::to_string(cumulative) + "\n";
+    }
+    text += "translator_script_run_seconds_sum " + std::to_string(static_cast<double>(run_nanoseconds) / 1e9) + "\n" +
+            "translator_script_run_seconds_count " + std::to_string(cumulative) + "\n";
+    return text;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+// --- МЕТРИКИ СЕРВИСА ---
+// Счётчики и гистограмма времени выполнения в текстовом формате Prometheus. У каждого потока своя копия счётчиков
+// (Shard), в которую пишет только он: запись - обычные load + store без блокировок и без lock-префикса, потоки
+// не делят строки кэша. Снятие (scrape) складывает копии всех потоков; копии ушедших потоков остаются в сумме.
+// Интерпретатор не трогается: инструкции считаются по Interpreter::instructions() после каждого отрезка.
+
+enum class Metric
+{
+    ScriptsCompiled, // Успешно скомпилированные программы (промахи кэша)
+    CompileErrors,
+    CacheHits,
+    CacheMisses,
+    Instructions,
+    InputBytes,      // Запросы: текст программ и значения для read()
+    OutputBytes,     // Ответы
+    FinishedOk,
+    FinishedError,
+    FinishedCompileError,
+    FinishedLimit,
+    Count
+};
+
+// Ошибки выполнения по виду - по тексту сообщения Interpreter::error()
+enum class RuntimeErrorKind
+{
+    DivisionByZero,
+    InputEnded,
+    InvalidInput,
+    StackUnderflow,
+    UndefinedLabel,
+    Limit,
+    Internal,
+    Other,
+    Count
+};
+
+RuntimeErrorKind runtimeErrorKind(const std::string &message);
+
+// Границы корзин гистограммы времени выполнения, секунды
+const double run_seconds_buckets[] = {0.0001, 0.001, 0.01, 0.1, 0.5, 1, 5, 10, 60};
+const size_t run_seconds_bucket_count = sizeof(run_seconds_buckets) / sizeof(run_seconds_buckets[0]);
+
+class MetricsRegistry
+{
+private:
+    static const size_t metric_count = static_cast<size_t>(Metric::Count);
+    static const size_t error_kind_count = static_cast<size_t>(RuntimeErrorKind::Count);
+
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> metrics[metric_count] = {};
+        std::atomic<uint64_t> errors[error_kind_count] = {};
+        std::atomic<uint64_t> buckets[run_seconds_bucket_count + 1] = {}; // Последняя - +Inf
+        std::atomic<uint64_t> run_nanoseconds{0};
+    };
+    mutable std::mutex shards_mutex; // Только регистрация потока и снятие
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    Shard &local()
+    {
+        thread_local Shard *shard = nullptr; // Реестр в процессе один
+        if (!shard)
+        {
+            std::lock_guard<std::mutex> lock(shards_mutex);
+            shards.push_back(std::make_unique<Shard>());
+            shard = shards.back().get();
+        }
+        return *shard;
+    }
+    // Пишет только владелец копии, поэтому без fetch_add; atomic - чтобы снятие читало без гонки
+    static void bump(std::atomic<uint64_t> &value, uint64_t by)
+    {
+        value.store(value.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+public:
+    void add(Metric metric, uint64_t by = 1)
+    {
+        bump(local().metrics[static_cast<size_t>(metric)], by);
+    }
+    void runtimeError(RuntimeErrorKind kind)
+    {
+        bump(local().errors[static_cast<size_t>(kind)], 1);
+    }
+    void observeRun(std::chrono::nanoseconds elapsed)
+    {
+        Shard &shard = local();
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        size_t bucket = 0;
+        while (bucket < run_seconds_bucket_count && seconds > run_seconds_buckets[bucket])
+            ++bucket;
+        bump(shard.buckets[bucket], 1);
+        bump(shard.run_nanoseconds, static_cast<uint64_t>(elapsed.count()));
+    }
+
+    std::string scrape() const;
+};
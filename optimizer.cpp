@@ -0,0 +1,967 @@
+#include "optimizer.h"
+#include <string>
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <cstring>
+#include <climits>
+#include "ir.h"
+
+namespace translator::detail
+{
+// --- ОПТИМИЗАТОР (проходы над IR в SSA-форме) ---
+// Каждый проход сохраняет наблюдаемое поведение программы: ввод, вывод и ошибки времени выполнения
+// (в том числе деление на ноль) происходят в том же порядке, что и без оптимизации.
+
+// Деление может завершиться ошибкой, если делитель не известная ненулевая константа.
+// -1 тоже исключается: INT_MIN / -1 для целых аварийно завершает программу.
+bool mayFault(const IRFunction &fn, const IRInstr &instr)
+{
+    if (instr.op != IROp::Binary || instr.bin != OPSCode::OP_DIV)
+        return false;
+    int divisor = instr.args[1];
+    if (divisor < 0 || fn.instrs[divisor].op != IROp::Const)
+        return true;
+    const std::variant<int, float> &c = fn.instrs[divisor].constant;
+    if (std::holds_alternative<int>(c))
+        return std::get<int>(c) == 0 || std::get<int>(c) == -1;
+    return std::get<float>(c) == 0.0f;
+}
+
+// Номер блока для каждой инструкции (-1 - инструкция выброшена)
+std::vector<int> instrBlocks(const IRFunction &fn)
+{
+    std::vector<int> block_of(fn.instrs.size(), -1);
+    for (size_t b = 0; b < fn.blocks.size(); ++b)
+        if (!fn.blocks[b].removed)
+            for (int id : fn.blocks[b].code)
+                block_of[id] = static_cast<int>(b);
+    return block_of;
+}
+
+// --- СВЁРТКА КОНСТАНТ ---
+// Те же правила, что в Interpreter::perform_binary_op: если один операнд float - считаем во float,
+// сравнения дают int 0/1. Целая арифметика переполняется по модулю, как на машине.
+// Деления, которые могут упасть, сюда не попадают (см. mayFault).
+std::variant<int, float> foldBinary(OPSCode code, const std::variant<int, float> &op1, const std::variant<int, float> &op2)
+{
+    if (code == OPSCode::OP_MUL_POW2)
+        code = OPSCode::OP_MUL;
+    else if (code == OPSCode::OP_DIV_CONST)
+        code = OPSCode::OP_DIV;
+    bool is_float = std::holds_alternative<float>(op1) || std::holds_alternative<float>(op2);
+    if (is_float)
+    {
+        float a = std::holds_alternative<float>(op1) ? std::get<float>(op1) : static_cast<float>(std::get<int>(op1));
+        float b = std::holds_alternative<float>(op2) ? std::get<float>(op2) : static_cast<float>(std::get<int>(op2));
+        switch (code)
+        {
+        case OPSCode::OP_ADD:
+            return a + b;
+        case OPSCode::OP_SUB:
+            return a - b;
+        case OPSCode::OP_MUL:
+            return a * b;
+        case OPSCode::OP_DIV:
+            return a / b;
+        case OPSCode::OP_LS:
+            return static_cast<int>(a < b);
+        case OPSCode::OP_LE:
+            return static_cast<int>(a <= b);
+        case OPSCode::OP_GS:
+            return static_cast<int>(a > b);
+        case OPSCode::OP_GE:
+            return static_cast<int>(a >= b);
+        case OPSCode::OP_EQ:
+            return static_cast<int>(a == b);
+        default:
+            return static_cast<int>(a != b);
+        }
+    }
+    int a = std::get<int>(op1), b = std::get<int>(op2);
+    unsigned ua = static_cast<unsigned>(a), ub = static_cast<unsigned>(b);
+    switch (code)
+    {
+    case OPSCode::OP_ADD:
+        return static_cast<int>(ua + ub);
+    case OPSCode::OP_SUB:
+        return static_cast<int>(ua - ub);
+    case OPSCode::OP_MUL:
+        return static_cast<int>(ua * ub);
+    case OPSCode::OP_DIV:
+        return a / b;
+    case OPSCode::OP_LS:
+        return static_cast<int>(a < b);
+    case OPSCode::OP_LE:
+        return static_cast<int>(a <= b);
+    case OPSCode::OP_GS:
+        return static_cast<int>(a > b);
+    case OPSCode::OP_GE:
+        return static_cast<int>(a >= b);
+    case OPSCode::OP_EQ:
+        return static_cast<int>(a == b);
+    default:
+        return static_cast<int>(a != b);
+    }
+}
+
+// Входы Phi приводятся к списку предшественников после удаления рёбер (с учётом кратности)
+void prunePhiInputs(IRFunction &fn)
+{
+    for (auto &block : fn.blocks)
+    {
+        if (block.removed)
+            continue;
+        for (int id : block.code)
+        {
+            IRInstr &phi = fn.instrs[id];
+            if (phi.op != IROp::Phi)
+                break;
+            std::vector<int> remaining = block.preds, args, blocks;
+            for (size_t k = 0; k < phi.args.size(); ++k)
+            {
+                auto it = std::find(remaining.begin(), remaining.end(), phi.phi_blocks[k]);
+                if (it == remaining.end())
+                    continue;
+                remaining.erase(it);
+                args.push_back(phi.args[k]);
+                blocks.push_back(phi.phi_blocks[k]);
+            }
+            phi.args.swap(args);
+            phi.phi_blocks.swap(blocks);
+        }
+    }
+}
+
+// --- УДАЛЕНИЕ МЁРТВОГО КОДА ---
+// Константные выражения сворачиваются, переход по константному условию становится безусловным,
+// недостижимые блоки выбрасываются. Затем по живости удаляются значения, которые никому не нужны:
+// присваивания, перезаписанные до чтения, и вычисления без потребителей. Ввод, вывод и деления,
+// которые могут упасть, остаются всегда. Метки без переходов к ним при опускании не выпускаются.
+// Возвращает число удалённых инструкций IR.
+int eliminateDeadCode(IRFunction &fn)
+{
+    auto countCode = [&]()
+    {
+        size_t total = 0;
+        for (const BasicBlock &block : fn.blocks)
+            if (!block.removed)
+                total += block.code.size();
+        return total;
+    };
+    size_t before = countCode();
+
+    std::vector<int> replacement(fn.instrs.size(), -1);
+    auto resolve = [&](int id)
+    {
+        while (id >= 0 && replacement[id] != -1)
+            id = replacement[id];
+        return id;
+    };
+    auto isConst = [&](int id)
+    { return id >= 0 && fn.instrs[id].op == IROp::Const; };
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        bool cfg_changed = false;
+        for (BasicBlock &block : fn.blocks)
+        {
+            if (block.removed)
+                continue;
+            for (int id : block.code)
+            {
+                IRInstr &instr = fn.instrs[id];
+                for (int &arg : instr.args)
+                    arg = resolve(arg);
+                if (instr.op == IROp::Phi && replacement[id] == -1)
+                {
+                    // После удаления рёбер у Phi может остаться одно значение
+                    int same = -2;
+                    for (int arg : instr.args)
+                        if (arg != id && arg != same)
+                            same = same == -2 ? arg : -1;
+                    if (same >= 0)
+                    {
+                        replacement[id] = same;
+                        changed = true;
+                    }
+                }
+                else if (instr.op == IROp::Binary && isConst(instr.args[0]) && isConst(instr.args[1]) && !mayFault(fn, instr))
+                {
+                    instr.constant = foldBinary(instr.bin, fn.instrs[instr.args[0]].constant, fn.instrs[instr.args[1]].constant);
+                    instr.op = IROp::Const;
+                    instr.args.clear();
+                    changed = true;
+                }
+            }
+            if (block.term != IRTerm::Branch)
+                continue;
+            block.cond = resolve(block.cond);
+            if (isConst(block.cond))
+            {
+                // Ложь - как в Interpreter::is_false: int 0 или float 0.0
+                const std::variant<int, float> &c = fn.instrs[block.cond].constant;
+                bool is_false = std::holds_alternative<int>(c) ? std::get<int>(c) == 0 : std::get<float>(c) == 0.0f;
+                block.succs = {block.succs[is_false ? 1 : 0]};
+                block.term = IRTerm::Jump;
+                block.cond = -1;
+                cfg_changed = changed = true;
+            }
+        }
+        if (cfg_changed)
+        {
+            fn.removeUnreachable();
+            prunePhiInputs(fn);
+        }
+    }
+
+    // Живы ввод, вывод, возможные ошибки, условия переходов и всё, от чего они зависят
+    std::vector<char> live(fn.instrs.size(), 0);
+    std::vector<int> work;
+    auto markLive = [&](int id)
+    {
+        if (id >= 0 && !live[id])
+        {
+            live[id] = 1;
+            work.push_back(id);
+        }
+    };
+    for (const BasicBlock &block : fn.blocks)
+    {
+        if (block.removed)
+            continue;
+        for (int id : block.code)
+        {
+            const IRInstr &instr = fn.instrs[id];
+            if (instr.op == IROp::Read || instr.op == IROp::Print || mayFault(fn, instr))
+                markLive(id);
+        }
+        if (block.term == IRTerm::Branch)
+            markLive(block.cond);
+    }
+    while (!work.empty())
+    {
+        int id = work.back();
+        work.pop_back();
+        for (int arg : fn.instrs[id].args)
+            markLive(arg);
+    }
+    for (BasicBlock &block : fn.blocks)
+    {
+        std::vector<int> kept;
+        for (int id : block.code)
+            if (live[id])
+                kept.push_back(id);
+        block.code.swap(kept);
+    }
+    return static_cast<int>(before - countCode());
+}
+
+// --- НУМЕРАЦИЯ ЗНАЧЕНИЙ В БЛОКЕ (локальное CSE) ---
+// Повторное вычисление той же операции над теми же значениями в пределах блока заменяется первым,
+// которое при опускании попадёт во временную переменную. В SSA запись в переменную создаёт новое значение,
+// поэтому после присваивания операнду ключ выражения сам перестаёт совпадать - отдельная инвалидация не нужна.
+// Деление, которое может упасть, тоже можно переиспользовать: первое выполняется раньше и упадёт первым.
+// Одинаковые константы сливаются по всей программе: они всё равно печатаются на месте использования.
+// Возвращает число удалённых инструкций.
+int numberValues(IRFunction &fn)
+{
+    std::vector<int> replacement(fn.instrs.size(), -1);
+    auto resolve = [&](int id)
+    { return id >= 0 && replacement[id] != -1 ? replacement[id] : id; };
+    auto commutative = [](OPSCode code)
+    { return code == OPSCode::OP_ADD || code == OPSCode::OP_MUL || code == OPSCode::OP_EQ || code == OPSCode::OP_NE; };
+
+    // Константа различается по типу и битам значения (0.0 и -0.0 - разные константы)
+    std::map<std::pair<int, uint32_t>, int> constants;
+    int removed = 0;
+    for (BasicBlock &block : fn.blocks)
+    {
+        if (block.removed)
+            continue;
+        std::map<std::tuple<OPSCode, int, int>, int> expressions;
+        std::vector<int> kept;
+        for (int id : block.code)
+        {
+            IRInstr &instr = fn.instrs[id];
+            for (int &arg : instr.args)
+                arg = resolve(arg);
+            int same = -1;
+            if (instr.op == IROp::Const)
+            {
+                std::pair<int, uint32_t> key(0, 0);
+                if (std::holds_alternative<int>(instr.constant))
+                    key.second = static_cast<uint32_t>(std::get<int>(instr.constant));
+                else
+                {
+                    float value = std::get<float>(instr.constant);
+                    key.first = 1;
+                    std::memcpy(&key.second, &value, sizeof(value));
+                }
+                same = constants.emplace(key, id).first->second;
+            }
+            else if (instr.op == IROp::Binary)
+            {
+                int a = instr.args[0], b = instr.args[1];
+                if (commutative(instr.bin) && b < a)
+                    std::swap(a, b);
+                same = expressions.emplace(std::make_tuple(instr.bin, a, b), id).first->second;
+            }
+            if (same != -1 && same != id)
+            {
+                replacement[id] = same;
+                removed++;
+                continue;
+            }
+            kept.push_back(id);
+        }
+        block.code.swap(kept);
+    }
+
+    // Замена использований: Phi и условия могут ссылаться на значения из других блоков
+    for (BasicBlock &block : fn.blocks)
+    {
+        if (block.removed)
+            continue;
+        for (int id : block.code)
+            for (int &arg : fn.instrs[id].args)
+                arg = resolve(arg);
+        if (block.term == IRTerm::Branch)
+            block.cond = resolve(block.cond);
+    }
+    return removed;
+}
+
+// --- ЦИКЛЫ ---
+// Естественный цикл: заголовок и все блоки, из которых без захода в заголовок достижимо обратное ребро
+struct Loop
+{
+    int header;
+    std::vector<int> latches; // Блоки с обратным ребром в заголовок
+    std::vector<int> blocks;  // Блоки цикла в обратном порядке обхода, заголовок первый
+};
+
+// Циклы программы, вложенные раньше объемлющих
+std::vector<Loop> findLoops(const IRFunction &fn)
+{
+    std::vector<int> rpo = fn.reversePostOrder();
+    std::vector<int> idom = fn.immediateDominators(rpo);
+    size_t block_count = fn.blocks.size();
+
+    // Нумерация дерева доминаторов: a доминирует над b <=> интервал b вложен в интервал a
+    std::vector<std::vector<int>> children(block_count);
+    for (int b : rpo)
+        if (b != 0)
+            children[idom[b]].push_back(b);
+    std::vector<int> enter(block_count, -1), leave(block_count, -1);
+    int clock = 0;
+    std::vector<std::pair<int, size_t>> stack = {{0, 0}};
+    enter[0] = clock++;
+    while (!stack.empty())
+    {
+        auto &top = stack.back();
+        if (top.second < children[top.first].size())
+        {
+            int child = children[top.first][top.second++];
+            enter[child] = clock++;
+            stack.push_back({child, 0});
+        }
+        else
+        {
+            leave[top.first] = clock++;
+            stack.pop_back();
+        }
+    }
+    auto dominates = [&](int a, int b)
+    { return enter[a] <= enter[b] && leave[b] <= leave[a]; };
+
+    std::vector<int> rpo_number(block_count, -1);
+    for (size_t i = 0; i < rpo.size(); ++i)
+        rpo_number[rpo[i]] = static_cast<int>(i);
+
+    std::vector<Loop> loops;
+    std::vector<int> loop_of_header(block_count, -1);
+    for (int b : rpo)
+        for (int s : fn.blocks[b].succs)
+            if (dominates(s, b))
+            {
+                if (loop_of_header[s] == -1)
+                {
+                    loop_of_header[s] = static_cast<int>(loops.size());
+                    loops.push_back({s, {}, {}});
+                }
+                loops[loop_of_header[s]].latches.push_back(b);
+            }
+
+    std::vector<char> in_loop(block_count, 0);
+    for (Loop &loop : loops)
+    {
+        std::vector<int> work = loop.latches;
+        in_loop[loop.header] = 1;
+        loop.blocks.push_back(loop.header);
+        while (!work.empty())
+        {
+            int b = work.back();
+            work.pop_back();
+            if (in_loop[b])
+                continue;
+            in_loop[b] = 1;
+            loop.blocks.push_back(b);
+            for (int p : fn.blocks[b].preds)
+                work.push_back(p);
+        }
+        for (int b : loop.blocks)
+            in_loop[b] = 0;
+        std::sort(loop.blocks.begin(), loop.blocks.end(), [&](int x, int y)
+                  { return rpo_number[x] < rpo_number[y]; });
+    }
+    std::stable_sort(loops.begin(), loops.end(), [](const Loop &x, const Loop &y)
+                     { return x.blocks.size() < y.blocks.size(); });
+    return loops;
+}
+
+// Предзаголовок - единственный вход в цикл снаружи, блок с безусловным переходом на заголовок.
+// Если такого нет, он создаётся; Phi заголовка получают значения входов через него.
+int ensurePreheader(IRFunction &fn, const Loop &loop)
+{
+    std::vector<char> in_loop(fn.blocks.size(), 0);
+    for (int b : loop.blocks)
+        in_loop[b] = 1;
+    std::vector<int> outside;
+    for (int p : fn.blocks[loop.header].preds)
+        if (!in_loop[p] && std::find(outside.begin(), outside.end(), p) == outside.end())
+            outside.push_back(p);
+    if (outside.size() == 1 && fn.blocks[outside[0]].term == IRTerm::Jump)
+        return outside[0];
+
+    int pre = fn.addBlock();
+    fn.blocks[pre].term = IRTerm::Jump;
+    fn.blocks[pre].succs = {loop.header};
+    for (int p : outside)
+        for (int &s : fn.blocks[p].succs)
+            if (s == loop.header)
+                s = pre;
+    for (int id : fn.blocks[loop.header].code)
+    {
+        if (fn.instrs[id].op != IROp::Phi)
+            break;
+        // Входы снаружи сливаются новой Phi в предзаголовке (или просто переезжают, если вход один)
+        IRInstr merged(IROp::Phi);
+        merged.var = fn.instrs[id].var;
+        std::vector<int> args, blocks;
+        for (size_t k = 0; k < fn.instrs[id].args.size(); ++k)
+        {
+            if (in_loop[fn.instrs[id].phi_blocks[k]])
+            {
+                args.push_back(fn.instrs[id].args[k]);
+                blocks.push_back(fn.instrs[id].phi_blocks[k]);
+            }
+            else
+            {
+                merged.args.push_back(fn.instrs[id].args[k]);
+                merged.phi_blocks.push_back(fn.instrs[id].phi_blocks[k]);
+            }
+        }
+        int incoming = merged.args.size() == 1 ? merged.args[0] : -1;
+        if (merged.args.size() > 1)
+        {
+            incoming = fn.add(merged);
+            fn.blocks[pre].code.push_back(incoming);
+        }
+        args.push_back(incoming);
+        blocks.push_back(pre);
+        fn.instrs[id].args = args;
+        fn.instrs[id].phi_blocks = blocks;
+    }
+    auto at = std::find(fn.layout.begin(), fn.layout.end(), loop.header);
+    fn.layout.insert(at, pre);
+    fn.computePreds();
+    return pre;
+}
+
+// --- ВЫНОС ИНВАРИАНТОВ ЦИКЛА (LICM) ---
+// Вычисление, все операнды которого определены вне цикла (или сами вынесены), переносится в предзаголовок,
+// а в цикле используется его значение из временной переменной. Деление, которое может упасть,
+// выносится только из заголовка до первого ввода/вывода или другой возможной ошибки:
+// заголовок выполняется при каждом входе в цикл, поэтому ошибка произойдёт в тот же момент.
+int hoistLoopInvariants(IRFunction &fn)
+{
+    // Сначала все предзаголовки: новые блоки должны попасть в тела объемлющих циклов
+    for (const Loop &loop : findLoops(fn))
+        ensurePreheader(fn, loop);
+
+    int hoisted = 0;
+    std::vector<Loop> loops = findLoops(fn);
+    std::vector<int> block_of = instrBlocks(fn);
+    std::vector<char> in_loop(fn.blocks.size(), 0);
+    for (const Loop &loop : loops)
+    {
+        int pre = ensurePreheader(fn, loop);
+        in_loop.resize(fn.blocks.size(), 0);
+        for (int b : loop.blocks)
+            in_loop[b] = 1;
+        auto invariant = [&](int arg)
+        { return arg >= 0 && (fn.instrs[arg].op == IROp::Const || !in_loop[block_of[arg]]); };
+
+        std::vector<int> moved;
+        for (int b : loop.blocks)
+        {
+            bool blocked = b != loop.header;
+            std::vector<int> kept;
+            for (int id : fn.blocks[b].code)
+            {
+                const IRInstr &instr = fn.instrs[id];
+                bool can_fault = mayFault(fn, instr);
+                bool movable = instr.op == IROp::Const ||
+                               (instr.op == IROp::Binary && invariant(instr.args[0]) && invariant(instr.args[1]));
+                if (movable && (!can_fault || !blocked))
+                {
+                    moved.push_back(id);
+                    block_of[id] = pre;
+                    if (instr.op == IROp::Binary)
+                        hoisted++;
+                    continue;
+                }
+                if (can_fault || instr.op == IROp::Read || instr.op == IROp::Print)
+                    blocked = true;
+                kept.push_back(id);
+            }
+            fn.blocks[b].code.swap(kept);
+        }
+        std::vector<int> &code = fn.blocks[pre].code;
+        code.insert(code.end(), moved.begin(), moved.end());
+        for (int b : loop.blocks)
+            in_loop[b] = 0;
+    }
+    return hoisted;
+}
+
+// --- ТИПЫ ЗНАЧЕНИЙ ---
+// Тип значения, если он известен при компиляции: read может дать и int, и float (Mixed).
+// None - ещё не вычислен; итерация до неподвижной точки начинается с него, поэтому счётчик цикла
+// "x = 5; ... x = x - 1" получается Int.
+enum class ValueType
+{
+    None,
+    Int,
+    Float,
+    Mixed
+};
+
+std::vector<ValueType> inferTypes(const IRFunction &fn)
+{
+    std::vector<ValueType> types(fn.instrs.size(), ValueType::None);
+    auto join = [](ValueType a, ValueType b)
+    {
+        if (a == ValueType::None || a == b)
+            return b;
+        return b == ValueType::None ? a : ValueType::Mixed;
+    };
+    std::vector<int> rpo = fn.reversePostOrder();
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int b : rpo)
+            for (int id : fn.blocks[b].code)
+            {
+                const IRInstr &instr = fn.instrs[id];
+                ValueType type = ValueType::None;
+                switch (instr.op)
+                {
+                case IROp::Const:
+                    type = std::holds_alternative<int>(instr.constant) ? ValueType::Int : ValueType::Float;
+                    break;
+                case IROp::Read:
+                    type = ValueType::Mixed;
+                    break;
+                case IROp::Phi:
+                    for (int arg : instr.args)
+                        if (arg >= 0)
+                            type = join(type, types[arg]);
+                    break;
+                case IROp::Binary:
+                {
+                    ValueType a = types[instr.args[0]], c = types[instr.args[1]];
+                    bool compare = instr.bin == OPSCode::OP_LS || instr.bin == OPSCode::OP_LE || instr.bin == OPSCode::OP_GS ||
+                                   instr.bin == OPSCode::OP_GE || instr.bin == OPSCode::OP_EQ || instr.bin == OPSCode::OP_NE;
+                    if (compare)
+                        type = ValueType::Int; // Сравнения всегда дают int 0/1
+                    else if (a == ValueType::Float || c == ValueType::Float)
+                        type = ValueType::Float; // Один float - и результат float
+                    else if (a == ValueType::None || c == ValueType::None)
+                        type = ValueType::None;
+                    else
+                        type = a == ValueType::Int && c == ValueType::Int ? ValueType::Int : ValueType::Mixed;
+                    break;
+                }
+                default:
+                    break;
+                }
+                if (type != types[id])
+                {
+                    types[id] = type;
+                    changed = true;
+                }
+            }
+    }
+    return types;
+}
+
+// --- РАЗВОРАЧИВАНИЕ ЦИКЛОВ ---
+// Цикл из заголовка и одного блока тела, условие которого сравнивает целый счётчик x с целой константой c,
+// а тело меняет x на константу шага (x = x - k или x = x + k). Перед ним ставится сторож:
+// если x ещё factor раз пройдёт проверку (x > c - (factor - 1) * шаг и т.п.), выполняется блок с factor
+// копиями заголовка и тела подряд, без проверок и переходов между ними. Иначе - исходный цикл, он же
+// доделывает остаток. Пока сторож истинен, x не переполняется, поэтому проверки действительно не нужны.
+// Ввод, вывод и ошибки в теле происходят в том же порядке: копии повторяют итерации буквально.
+const size_t unroll_budget = 64; // Наибольший размер развёрнутого блока, инструкций IR
+
+int unrollLoops(IRFunction &fn, int factor)
+{
+    if (factor < 2)
+        return 0;
+    std::vector<ValueType> types = inferTypes(fn);
+    auto intConstant = [&](int id)
+    { return id >= 0 && fn.instrs[id].op == IROp::Const && std::holds_alternative<int>(fn.instrs[id].constant); };
+    auto phiInput = [&](int phi, int from)
+    {
+        const IRInstr &instr = fn.instrs[phi];
+        for (size_t k = 0; k < instr.phi_blocks.size(); ++k)
+            if (instr.phi_blocks[k] == from)
+                return instr.args[k];
+        return -1;
+    };
+
+    int unrolled = 0;
+    for (const Loop &loop : findLoops(fn))
+    {
+        int h = loop.header;
+        if (loop.blocks.size() != 2 || loop.latches.size() != 1)
+            continue;
+        int body = loop.latches[0];
+        if (fn.blocks[h].term != IRTerm::Branch || fn.blocks[h].succs[0] != body || fn.blocks[h].succs[1] == body)
+            continue;
+
+        // Условие: x cmp c; константа слева переносится направо с зеркальным сравнением
+        const IRInstr &cond = fn.instrs[fn.blocks[h].cond];
+        if (cond.op != IROp::Binary)
+            continue;
+        OPSCode cmp = cond.bin;
+        int x = cond.args[0], bound = cond.args[1];
+        if (intConstant(x))
+        {
+            std::swap(x, bound);
+            if (cmp == OPSCode::OP_LS)
+                cmp = OPSCode::OP_GS;
+            else if (cmp == OPSCode::OP_GS)
+                cmp = OPSCode::OP_LS;
+            else if (cmp == OPSCode::OP_LE)
+                cmp = OPSCode::OP_GE;
+            else if (cmp == OPSCode::OP_GE)
+                cmp = OPSCode::OP_LE;
+        }
+        bool decreasing = cmp == OPSCode::OP_GS || cmp == OPSCode::OP_GE;
+        if ((!decreasing && cmp != OPSCode::OP_LS && cmp != OPSCode::OP_LE) || !intConstant(bound) ||
+            x < 0 || fn.instrs[x].op != IROp::Phi || types[x] != ValueType::Int ||
+            std::find(fn.blocks[h].code.begin(), fn.blocks[h].code.end(), x) == fn.blocks[h].code.end())
+            continue;
+
+        // Шаг: значение x, приходящее из тела, равно x - k или x + k
+        int next = phiInput(x, body);
+        if (next < 0 || fn.instrs[next].op != IROp::Binary)
+            continue;
+        const IRInstr &step = fn.instrs[next];
+        long long delta = 0;
+        if (step.bin == OPSCode::OP_SUB && step.args[0] == x && intConstant(step.args[1]))
+            delta = -static_cast<long long>(std::get<int>(fn.instrs[step.args[1]].constant));
+        else if (step.bin == OPSCode::OP_ADD && step.args[0] == x && intConstant(step.args[1]))
+            delta = std::get<int>(fn.instrs[step.args[1]].constant);
+        else if (step.bin == OPSCode::OP_ADD && step.args[1] == x && intConstant(step.args[0]))
+            delta = std::get<int>(fn.instrs[step.args[0]].constant);
+        if (delta == 0 || (delta < 0) != decreasing)
+            continue;
+        long long limit = std::get<int>(fn.instrs[bound].constant) - (factor - 1) * delta;
+        if (limit < INT_MIN || limit > INT_MAX)
+            continue;
+
+        // Копируется всё, что выполняется за итерацию: заголовок без Phi и тело
+        std::vector<int> iteration;
+        for (int id : fn.blocks[h].code)
+            if (fn.instrs[id].op != IROp::Phi)
+                iteration.push_back(id);
+        iteration.insert(iteration.end(), fn.blocks[body].code.begin(), fn.blocks[body].code.end());
+        if (iteration.size() * factor > unroll_budget)
+            continue;
+
+        int pre = ensurePreheader(fn, loop);
+        int guard = fn.addBlock(), wide = fn.addBlock();
+        std::vector<int> phis;
+        for (int id : fn.blocks[h].code)
+            if (fn.instrs[id].op == IROp::Phi)
+                phis.push_back(id);
+
+        // Phi сторожа: вход из предзаголовка или значение после развёрнутого блока
+        std::unordered_map<int, int> current; // Значение в исходном цикле -> его копия
+        for (int phi : phis)
+        {
+            IRInstr merged(IROp::Phi);
+            merged.var = fn.instrs[phi].var;
+            merged.args = {phiInput(phi, pre), -1};
+            merged.phi_blocks = {pre, wide};
+            int id = fn.add(merged);
+            fn.blocks[guard].code.push_back(id);
+            current[phi] = id;
+        }
+        for (int copy = 0; copy < factor; ++copy)
+        {
+            for (int id : iteration)
+            {
+                IRInstr clone = fn.instrs[id];
+                for (int &arg : clone.args)
+                {
+                    auto it = current.find(arg);
+                    if (it != current.end())
+                        arg = it->second;
+                }
+                int clone_id = fn.add(clone);
+                fn.blocks[wide].code.push_back(clone_id);
+                current[id] = clone_id;
+            }
+            // Следующая итерация видит в Phi заголовка значения, пришедшие из тела
+            std::vector<int> latched;
+            for (int phi : phis)
+            {
+                int value = phiInput(phi, body);
+                auto it = current.find(value);
+                latched.push_back(it != current.end() ? it->second : value);
+            }
+            for (size_t k = 0; k < phis.size(); ++k)
+                current[phis[k]] = latched[k];
+        }
+        for (size_t k = 0; k < phis.size(); ++k)
+        {
+            IRInstr &merged = fn.instrs[fn.blocks[guard].code[k]];
+            merged.args[1] = current[phis[k]];
+            // Исходный цикл теперь входит из сторожа
+            IRInstr &phi = fn.instrs[phis[k]];
+            for (size_t j = 0; j < phi.phi_blocks.size(); ++j)
+                if (phi.phi_blocks[j] == pre)
+                {
+                    phi.phi_blocks[j] = guard;
+                    phi.args[j] = fn.blocks[guard].code[k];
+                }
+        }
+
+        IRInstr limit_const(IROp::Const);
+        limit_const.constant = static_cast<int>(limit);
+        int limit_id = fn.add(limit_const);
+        IRInstr check(IROp::Binary);
+        check.bin = cmp;
+        check.args = {fn.blocks[guard].code[std::find(phis.begin(), phis.end(), x) - phis.begin()], limit_id};
+        int check_id = fn.add(check);
+        fn.blocks[guard].code.push_back(limit_id);
+        fn.blocks[guard].code.push_back(check_id);
+        fn.blocks[guard].term = IRTerm::Branch;
+        fn.blocks[guard].cond = check_id;
+        fn.blocks[guard].succs = {wide, h};
+        fn.blocks[wide].term = IRTerm::Jump;
+        fn.blocks[wide].succs = {guard};
+        for (int &s : fn.blocks[pre].succs)
+            if (s == h)
+                s = guard;
+        auto at = std::find(fn.layout.begin(), fn.layout.end(), h);
+        at = fn.layout.insert(at, guard);
+        fn.layout.insert(at + 1, wide);
+        fn.computePreds();
+        types.resize(fn.instrs.size(), ValueType::None);
+        unrolled++;
+    }
+    return unrolled;
+}
+
+// --- УПРОЩЕНИЕ ОПЕРАЦИЙ (strength reduction) ---
+// Умножение на целую степень двойки становится сдвигом, деление на целую константу (кроме 0 и +-1) -
+// умножением на магическое число без проверки на ноль. Тип второго операнда известен (int), а первого -
+// нет, поэтому новые операции сами выбирают путь по типу: для float вычисляется обычное * или /.
+int reduceStrength(IRFunction &fn)
+{
+    auto intConstant = [&](int id, int &value)
+    {
+        if (id < 0 || fn.instrs[id].op != IROp::Const || !std::holds_alternative<int>(fn.instrs[id].constant))
+            return false;
+        value = std::get<int>(fn.instrs[id].constant);
+        return true;
+    };
+    int reduced = 0;
+    for (const BasicBlock &block : fn.blocks)
+    {
+        if (block.removed)
+            continue;
+        for (int id : block.code)
+        {
+            IRInstr &instr = fn.instrs[id];
+            if (instr.op != IROp::Binary)
+                continue;
+            int c;
+            if (instr.bin == OPSCode::OP_MUL)
+            {
+                // Константа слева переставляется направо: оба операнда - уже вычисленные значения
+                if (intConstant(instr.args[0], c) && !intConstant(instr.args[1], c))
+                    std::swap(instr.args[0], instr.args[1]);
+                if (intConstant(instr.args[1], c) && c >= 2 && (c & (c - 1)) == 0)
+                {
+                    instr.bin = OPSCode::OP_MUL_POW2;
+                    reduced++;
+                }
+            }
+            else if (instr.bin == OPSCode::OP_DIV && intConstant(instr.args[1], c) && c != 0 && c != 1 && c != -1)
+            {
+                instr.bin = OPSCode::OP_DIV_CONST;
+                reduced++;
+            }
+        }
+    }
+    return reduced;
+}
+
+// --- ПРОБРОС ПЕРЕХОДОВ (jump threading) ---
+// Пустой блок с безусловным переходом (пустой else, конец then перед меткой, опустевший предзаголовок)
+// пропускается: его предшественники переходят сразу к цели. Если у цели есть Phi, вход из пустого блока
+// переходит к предшественнику; предшественник, уже ведущий в цель, не трогается - у него был бы второй вход.
+// Ветвление, обе стороны которого ведут в один блок, становится безусловным переходом.
+// Возвращает число перенаправленных рёбер.
+int threadJumps(IRFunction &fn)
+{
+    auto hasPhi = [&](int b)
+    { return !fn.blocks[b].code.empty() && fn.instrs[fn.blocks[b].code[0]].op == IROp::Phi; };
+    int threaded = 0;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t e = 1; e < fn.blocks.size(); ++e)
+        {
+            BasicBlock &empty = fn.blocks[e];
+            if (empty.removed || !empty.code.empty() || empty.term != IRTerm::Jump || empty.succs[0] == static_cast<int>(e))
+                continue;
+            int target = empty.succs[0];
+            int before = threaded;
+            std::vector<int> preds = empty.preds;
+            preds.erase(std::unique(preds.begin(), preds.end()), preds.end());
+            for (int p : preds)
+            {
+                std::vector<int> &succs = fn.blocks[p].succs;
+                if (hasPhi(target) && std::find(succs.begin(), succs.end(), target) != succs.end())
+                    continue;
+                for (int &s : succs)
+                {
+                    if (s != static_cast<int>(e))
+                        continue;
+                    s = target;
+                    threaded++;
+                    // Значение, которое приходило через пустой блок, теперь приходит из p
+                    for (int id : fn.blocks[target].code)
+                    {
+                        IRInstr &phi = fn.instrs[id];
+                        if (phi.op != IROp::Phi)
+                            break;
+                        for (size_t k = 0; k < phi.phi_blocks.size(); ++k)
+                            if (phi.phi_blocks[k] == static_cast<int>(e))
+                            {
+                                phi.args.push_back(phi.args[k]);
+                                phi.phi_blocks.push_back(p);
+                                break;
+                            }
+                    }
+                }
+                BasicBlock &pred = fn.blocks[p];
+                if (pred.term == IRTerm::Branch && pred.succs[0] == pred.succs[1])
+                {
+                    pred.term = IRTerm::Jump;
+                    pred.succs.pop_back();
+                    pred.cond = -1;
+                }
+            }
+            if (threaded != before)
+            {
+                fn.computePreds();
+                changed = true;
+            }
+        }
+    }
+    fn.removeUnreachable();
+    prunePhiInputs(fn);
+    return threaded;
+}
+
+// --- ДРАЙВЕР ---
+bool optimizeOPS(std::vector<OPSElement> &ops_code, const OptimizerOptions &options)
+{
+    bool dump = options.dump_ir;
+    IRFunction fn;
+    if (!buildIR(ops_code, fn))
+    {
+        *options.err << "Optimizer: OPS has an unsupported shape, optimization skipped." << std::endl;
+        return false;
+    }
+    if (dump)
+        fn.dump(*options.out, "CFG");
+    if (!constructSSA(fn))
+    {
+        *options.err << "Optimizer: SSA construction failed, optimization skipped." << std::endl;
+        return false;
+    }
+    if (dump)
+        fn.dump(*options.out, "SSA");
+
+    int removed = eliminateDeadCode(fn);
+    if (dump)
+        fn.dump(*options.out, "after DCE, removed " + std::to_string(removed));
+
+    int numbered = numberValues(fn);
+    if (dump)
+        fn.dump(*options.out, "after value numbering, reused " + std::to_string(numbered));
+
+    int hoisted = hoistLoopInvariants(fn);
+    if (dump)
+        fn.dump(*options.out, "after LICM, hoisted " + std::to_string(hoisted));
+
+    int unrolled = unrollLoops(fn, options.unroll_factor);
+    if (dump)
+        fn.dump(*options.out, "after unrolling, unrolled " + std::to_string(unrolled));
+
+    int reduced = reduceStrength(fn);
+    if (dump)
+        fn.dump(*options.out, "after strength reduction, reduced " + std::to_string(reduced));
+
+    // Пробросы могут оставить условия без переходов - их подбирает повторная чистка
+    int threaded = threadJumps(fn);
+    removed += eliminateDeadCode(fn);
+    if (dump)
+        fn.dump(*options.out, "after jump threading, threaded " + std::to_string(threaded));
+
+    size_t ops_before = ops_code.size();
+    std::vector<int> origins;
+    ops_code = lowerIR(fn, options.positions ? &origins : nullptr);
+    if (options.positions)
+    {
+        // Элемент без происхождения (копии Phi, метки) наследует позицию предыдущего
+        std::vector<SourcePosition> &positions = *options.positions;
+        std::vector<SourcePosition> remapped(ops_code.size());
+        for (size_t k = 0; k < ops_code.size(); ++k)
+        {
+            if (origins[k] >= 0 && static_cast<size_t>(origins[k]) < positions.size())
+                remapped[k] = positions[origins[k]];
+            else if (k > 0)
+                remapped[k] = remapped[k - 1];
+        }
+        positions.swap(remapped);
+    }
+    *options.out << "Optimizer: removed " << removed << " dead IR instructions, OPS "
+              << ops_before << " -> " << ops_code.size() << " elements" << std::endl;
+    return true;
+}
+} // namespace translator::detail
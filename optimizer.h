@@ -0,0 +1,25 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include "syntaxer.h"
+
+namespace translator::detail
+{
+// Во сколько раз разворачивать циклы по умолчанию (--unroll)
+const int default_unroll_factor = 4;
+
+// Настройки оптимизатора (флаги командной строки)
+struct OptimizerOptions
+{
+    bool dump_ir;      // --dump-ir: печатать IR после каждого этапа
+    int unroll_factor; // --unroll=N: во сколько раз разворачивать циклы, 0 или 1 - не разворачивать
+    std::ostream *out; // Куда печатать дампы и итог
+    std::ostream *err; // Куда печатать, почему оптимизация пропущена
+    std::vector<SourcePosition> *positions; // Таблица позиций ОПС (профилировщик): переводится вместе с ОПС
+
+    OptimizerOptions() : dump_ir(false), unroll_factor(default_unroll_factor), out(&std::cout), err(&std::cerr), positions(nullptr) {}
+};
+
+// Прогон ОПС через IR (режим -O): CFG -> SSA -> проходы -> ОПС. При неудаче ОПС остаётся прежней.
+bool optimizeOPS(std::vector<OPSElement> &ops_code, const OptimizerOptions &options);
+} // namespace translator::detail
@@ -0,0 +1,46 @@
+#include "output.h"
+#include <unistd.h> // Для write
+
+namespace translator::detail
+{
+FloatFormat floatFormatOf(const std::ostream &out)
+{
+    bool fixed = (out.flags() & std::ios::floatfield) == std::ios::fixed;
+    return {fixed ? std::chars_format::fixed : std::chars_format::general, static_cast<int>(out.precision())};
+}
+
+void OutputBuffer::flush()
+{
+    if (used == 0)
+    {
+        if (stream)
+            stream->flush();
+        return;
+    }
+    if (stream)
+    {
+        stream->write(buffer.data(), static_cast<std::streamsize>(used));
+        stream->flush();
+    }
+    else if (text)
+        text->append(buffer.data(), used);
+    else
+    {
+        std::cout.flush();
+        writeAll(buffer.data(), used);
+    }
+    used = 0;
+}
+
+void OutputBuffer::writeAll(const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t written = ::write(fd, data, size);
+        if (written <= 0)
+            return; // Закрытый выход: дальше писать некуда
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+} // namespace translator::detail
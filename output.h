@@ -0,0 +1,101 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <charconv>
+#include <algorithm>
+
+namespace translator::detail
+{
+// --- ВЫВОД ПРОГРАММЫ ---
+// print() пишет в большой буфер, а не в cout с endl на каждой строке. Буфер сбрасывается, когда заполнен,
+// перед приглашением read (его должно быть видно до ввода), перед сообщением об ошибке и в конце выполнения.
+// Числа форматируются через to_chars. Вывод идёт в поток (по умолчанию cout), прямо в файловый дескриптор
+// или в строку (пакетный прогон собирает вывод каждой записи отдельно).
+
+// float печатается так же, как напечатал бы поток с текущими настройками:
+// printOPS переключает cout в fixed с двумя знаками, если в ОПС есть вещественная константа
+struct FloatFormat
+{
+    std::chars_format format;
+    int precision;
+};
+FloatFormat floatFormatOf(const std::ostream &out);
+
+class OutputBuffer
+{
+private:
+    static const size_t capacity = 1 << 16;
+    static const size_t number_room = 64; // Больше любого int и float (FLT_MAX в fixed с двумя знаками - 42 символа)
+
+    std::vector<char> buffer;
+    size_t used;
+    std::ostream *stream; // Куда сбрасывать: поток, строка или (оба nullptr) fd
+    std::string *text;
+    int fd;
+    FloatFormat float_format;
+
+    void reserve(size_t size)
+    {
+        if (used + size > capacity)
+            flush();
+    }
+
+public:
+    explicit OutputBuffer(std::ostream &out)
+        : buffer(capacity), used(0), stream(&out), text(nullptr), fd(-1), float_format(floatFormatOf(out)) {}
+    explicit OutputBuffer(int descriptor)
+        : buffer(capacity), used(0), stream(nullptr), text(nullptr), fd(descriptor), float_format(floatFormatOf(std::cout)) {}
+    // Вывод дописывается в target при каждом сбросе; формат задаётся явно, без обращения к cout
+    OutputBuffer(std::string &target, FloatFormat format)
+        : buffer(capacity), used(0), stream(nullptr), text(&target), fd(-1), float_format(format) {}
+    ~OutputBuffer() { flush(); }
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    // --stream узнаёт о вещественных константах по ходу программы; уже записанное не меняется
+    void setFloatFormat(FloatFormat format) { float_format = format; }
+
+    void write(const char *data, size_t size)
+    {
+        if (size > capacity)
+        {
+            flush();
+            if (stream)
+                stream->write(data, static_cast<std::streamsize>(size));
+            else if (text)
+                text->append(data, size);
+            else
+                writeAll(data, size);
+            return;
+        }
+        reserve(size);
+        std::copy(data, data + size, buffer.data() + used);
+        used += size;
+    }
+    void write(const std::string &value) { write(value.data(), value.size()); }
+    void writeChar(char c)
+    {
+        reserve(1);
+        buffer[used++] = c;
+    }
+    void writeInt(int value)
+    {
+        reserve(number_room);
+        char *end = std::to_chars(buffer.data() + used, buffer.data() + capacity, value).ptr;
+        used = end - buffer.data();
+    }
+    void writeFloat(float value)
+    {
+        reserve(number_room);
+        char *end = std::to_chars(buffer.data() + used, buffer.data() + capacity, value, float_format.format, float_format.precision).ptr;
+        used = end - buffer.data();
+    }
+
+    // Отдаёт накопленное. Поток cout сбрасывается до записи в fd, чтобы не перепутать порядок.
+    void flush();
+
+private:
+    void writeAll(const char *data, size_t size);
+};
+} // namespace translator::detail
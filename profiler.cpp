@@ -0,0 +1,160 @@
+#include "profiler.h"
+#include <iomanip>
+#include <map>
+#include <algorithm>
+
+namespace translator::detail
+{
+// Код операции так же, как в распечатке ОПС
+const char *profileOpName(OPSCode code)
+{
+    switch (code)
+    {
+    case OPSCode::OP_INT_CONST:
+        return "INT";
+    case OPSCode::OP_FLOAT_CONST:
+        return "FLOAT";
+    case OPSCode::OP_IDENT:
+        return "ID";
+    case OPSCode::OP_ADD:
+        return "+";
+    case OPSCode::OP_SUB:
+        return "-";
+    case OPSCode::OP_MUL:
+        return "*";
+    case OPSCode::OP_DIV:
+        return "/";
+    case OPSCode::OP_MUL_POW2:
+        return "*<<";
+    case OPSCode::OP_DIV_CONST:
+        return "/c";
+    case OPSCode::OP_LS:
+        return "<";
+    case OPSCode::OP_LE:
+        return "<=";
+    case OPSCode::OP_GS:
+        return ">";
+    case OPSCode::OP_GE:
+        return ">=";
+    case OPSCode::OP_EQ:
+        return "==";
+    case OPSCode::OP_NE:
+        return "<>";
+    case OPSCode::OP_JF:
+        return "JF";
+    case OPSCode::OP_JT:
+        return "JT";
+    case OPSCode::OP_JMP:
+        return "JMP";
+    case OPSCode::OP_ASSIGN:
+        return "=";
+    case OPSCode::OP_READ:
+        return "READ";
+    case OPSCode::OP_PRINT:
+        return "PRINT";
+    case OPSCode::OP_LABEL:
+        return "LABEL";
+    default:
+        return "ERROR";
+    }
+}
+
+// Элемент с операндом: "ID x", "INT 5", "L3:"
+string profileElementText(const OPSElement &element)
+{
+    string text = profileOpName(element.code);
+    if (element.code == OPSCode::OP_INT_CONST)
+        text += " " + to_string(get<int>(element.value));
+    else if (element.code == OPSCode::OP_FLOAT_CONST)
+        text += " " + to_string(get<float>(element.value));
+    else if (holds_alternative<string>(element.value))
+        text = element.code == OPSCode::OP_LABEL ? get<string>(element.value) : text + " " + get<string>(element.value);
+    return text;
+}
+
+string profileLocation(const vector<SourcePosition> &positions, size_t index)
+{
+    if (index >= positions.size() || positions[index].row == 0)
+        return "?";
+    return to_string(positions[index].row) + ":" + to_string(positions[index].column);
+}
+
+void writeProfileReport(ostream &out, const vector<OPSElement> &ops_code, const vector<SourcePosition> &positions,
+                        const ExecutionProfile &profile, size_t top)
+{
+    struct Row
+    {
+        string name;
+        uint64_t count = 0, ticks = 0;
+    };
+    uint64_t total_count = 0, total_ticks = 0;
+    map<string, Row> by_op;
+    map<size_t, Row> by_line;
+    vector<size_t> hot;
+    for (size_t i = 0; i < profile.counts.size() && i < ops_code.size(); ++i)
+    {
+        if (profile.counts[i] == 0)
+            continue;
+        total_count += profile.counts[i];
+        total_ticks += profile.ticks[i];
+        Row &op = by_op[profileOpName(ops_code[i].code)];
+        op.name = profileOpName(ops_code[i].code);
+        op.count += profile.counts[i];
+        op.ticks += profile.ticks[i];
+        size_t line = i < positions.size() ? positions[i].row : 0;
+        Row &source = by_line[line];
+        source.name = line ? "line " + to_string(line) : "line ?";
+        source.count += profile.counts[i];
+        source.ticks += profile.ticks[i];
+        hot.push_back(i);
+    }
+    auto share = [&](uint64_t ticks) { return total_ticks ? 100.0 * static_cast<double>(ticks) / static_cast<double>(total_ticks) : 0.0; };
+    auto table = [&](const string &title, vector<Row> rows)
+    {
+        sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) { return a.ticks > b.ticks; });
+        out << title << "\n"
+            << "  " << left << setw(12) << "" << right << setw(14) << "count" << setw(16) << "ticks" << setw(8) << "%" << setw(12) << "ticks/exec" << "\n";
+        for (const Row &row : rows)
+            out << "  " << left << setw(12) << row.name << right << setw(14) << row.count << setw(16) << row.ticks << setw(7)
+                << fixed << setprecision(1) << share(row.ticks) << "%" << setw(12) << setprecision(1)
+                << static_cast<double>(row.ticks) / static_cast<double>(row.count) << "\n";
+    };
+
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    out << "--- Profile: " << total_count << " instructions, " << total_ticks << " ticks ---\n";
+    vector<Row> rows;
+    for (const auto &entry : by_op)
+        rows.push_back(entry.second);
+    table("By opcode:", rows);
+    rows.clear();
+    for (const auto &entry : by_line)
+        rows.push_back(entry.second);
+    table("By source line:", rows);
+
+    sort(hot.begin(), hot.end(), [&](size_t a, size_t b) { return profile.ticks[a] > profile.ticks[b]; });
+    if (hot.size() > top)
+        hot.resize(top);
+    out << "Hot OPS elements:\n"
+        << "  " << right << setw(6) << "index" << "  " << left << setw(14) << "element" << setw(9) << "source" << right << setw(14)
+        << "count" << setw(16) << "ticks" << setw(8) << "%" << "\n";
+    for (size_t i : hot)
+        out << "  " << right << setw(6) << i << "  " << left << setw(14) << profileElementText(ops_code[i]) << setw(9)
+            << profileLocation(positions, i) << right << setw(14) << profile.counts[i] << setw(16) << profile.ticks[i] << setw(7)
+            << fixed << setprecision(1) << share(profile.ticks[i]) << "%\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void writeFoldedStacks(ostream &out, const string &program, const vector<OPSElement> &ops_code,
+                       const vector<SourcePosition> &positions, const ExecutionProfile &profile)
+{
+    map<pair<size_t, string>, uint64_t> stacks;
+    for (size_t i = 0; i < profile.counts.size() && i < ops_code.size(); ++i)
+        if (profile.ticks[i] != 0)
+            stacks[{i < positions.size() ? positions[i].row : 0, profileOpName(ops_code[i].code)}] += profile.ticks[i];
+    for (const auto &entry : stacks)
+        out << program << ";line " << (entry.first.first ? to_string(entry.first.first) : string("?")) << ";"
+            << entry.first.second << " " << entry.second << "\n";
+}
+} // namespace translator::detail
@@ -0,0 +1,82 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // Для __rdtsc
+#endif
+#include "syntaxer.h"
+
+namespace translator::detail
+{
+// --- ПРОФИЛИРОВЩИК ---
+// В режиме профиля (--profile) интерпретатор считает для каждого элемента ОПС, сколько раз он выполнен
+// и сколько тактов прошло от его начала до начала следующего (TSC на x86, иначе наносекунды).
+// По таблице позиций парсера элементы привязываются к строкам исходника: отчёт по кодам операций, строкам
+// и самым горячим элементам, а свёрнутые стеки (--profile-folded=FILE) читают flamegraph.pl, inferno и speedscope.
+// Без профиля интерпретатор выполняет отдельную копию цикла, в которой этих счётчиков нет.
+
+inline uint64_t profileTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+struct ExecutionProfile
+{
+    vector<uint64_t> counts; // Сколько раз выполнен ops_code[i]
+    vector<uint64_t> ticks;  // Сколько тактов ушло на ops_code[i]
+    size_t open_index;       // Элемент, чьё время ещё идёт, SIZE_MAX - нет
+    uint64_t open_since;
+
+    ExecutionProfile() : open_index(SIZE_MAX), open_since(0) {}
+
+    // Счётчики под ОПС из size элементов; уже набранные не сбрасываются, если размер тот же
+    void prepare(size_t size)
+    {
+        if (counts.size() != size)
+        {
+            counts.assign(size, 0);
+            ticks.assign(size, 0);
+        }
+        open_index = SIZE_MAX;
+    }
+    // Начинается элемент index: время предыдущего закрывается
+    void enter(size_t index)
+    {
+        uint64_t now = profileTicks();
+        close(now);
+        open_index = index;
+        open_since = now;
+        ++counts[index];
+    }
+    void close(uint64_t now)
+    {
+        if (open_index != SIZE_MAX)
+            ticks[open_index] += now - open_since;
+        open_index = SIZE_MAX;
+    }
+    // Профили потоков пакетного прогона складываются в один
+    void merge(const ExecutionProfile &other)
+    {
+        prepare(other.counts.size());
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            counts[i] += other.counts[i];
+            ticks[i] += other.ticks[i];
+        }
+    }
+};
+
+// Отчёт: по кодам операций, по строкам исходника и top самых горячих элементов ОПС, всё по убыванию тактов
+void writeProfileReport(ostream &out, const vector<OPSElement> &ops_code, const vector<SourcePosition> &positions,
+                        const ExecutionProfile &profile, size_t top = 20);
+// Свёрнутые стеки "программа;line N;операция такты" - по строке на пару (строка исходника, код операции)
+void writeFoldedStacks(ostream &out, const string &program, const vector<OPSElement> &ops_code,
+                       const vector<SourcePosition> &positions, const ExecutionProfile &profile);
+} // namespace translator::detail
@@ -0,0 +1,77 @@
+#include "scheduler.h"
+
+void WorkStealingPool::push(size_t index, Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        ++queued;
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    idle_cv.notify_one();
+}
+
+bool WorkStealingPool::take(size_t index, Task &task)
+{
+    for (size_t k = 0; k < workers.size(); ++k)
+    {
+        Worker &worker = *workers[(index + k) % workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty())
+            continue;
+        if (k == 0)
+        {
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        }
+        else
+        {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+        }
+        --queued;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::loop(size_t index)
+{
+    for (;;)
+    {
+        Task task;
+        if (take(index, task))
+        {
+            if (task())
+                push(index, std::move(task));
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        idle_cv.wait(lock, [&]() { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
+
+WorkStealingPool::WorkStealingPool(unsigned thread_count) : next_worker(0), queued(0), stopping(false)
+{
+    if (thread_count == 0)
+        thread_count = 1;
+    for (unsigned i = 0; i < thread_count; ++i)
+        workers.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < thread_count; ++i)
+        threads.emplace_back(&WorkStealingPool::loop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        stopping = true;
+    }
+    idle_cv.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+// --- ПЛАНИРОВЩИК С КРАЖЕЙ РАБОТЫ ---
+// У каждого потока своя очередь задач. Поток берёт задачи из начала своей очереди, а когда она пуста -
+// крадёт из конца чужой. Задача делает один отрезок работы и возвращает true, если её нужно продолжить:
+// тогда она встаёт в конец очереди того же потока, и остальные задачи этой очереди получают свой отрезок.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<bool()>;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> next_worker; // Новые задачи раздаются по кругу
+    std::atomic<size_t> queued;      // Задач во всех очередях; растёт только под idle_mutex
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+    bool stopping;
+
+    // queued растёт раньше, чем задача попадает в очередь: иначе её успели бы украсть и уменьшить счётчик до
+    // увеличения, он ушёл бы ниже нуля (в SIZE_MAX), и простаивающие потоки крутились бы без задач. Так счётчик
+    // может лишь ненадолго завысить число задач - поток проснётся, не найдёт задачу и заснёт снова, - а выход
+    // по stopping && queued == 0 не случится, пока задача не взята.
+    void push(size_t index, Task task);
+    // Своя очередь с начала, иначе чужие с конца
+    bool take(size_t index, Task &task);
+    void loop(size_t index);
+
+public:
+    explicit WorkStealingPool(unsigned thread_count);
+    // Дожидается всех задач, в том числе тех, что ещё будут продолжены
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    void submit(Task task) { push(next_worker++ % workers.size(), std::move(task)); }
+};
@@ -0,0 +1,746 @@
+// --- СЕРВИС ВЫПОЛНЕНИЯ ПРОГРАММ ---
+// Долгоживущий процесс: принимает программы через Unix-сокет (--socket=PATH) и/или каталог-спул (--spool=DIR),
+// компилирует их и выполняет на пуле потоков с кражей работы. Каждая программа выполняется отрезками по --slice
+// инструкций, после отрезка встаёт в конец очереди, поэтому длинный while не задерживает остальные программы.
+//
+// Запрос: текст программы, затем (необязательно) строка "%%" и значения для read() через пробел или запятую.
+// Через сокет программа компилируется, как только пришла строка "%%", а значения можно досылать во время
+// выполнения: read(), которому не хватило ввода, снимает программу с пула (поток не занят), и она продолжается,
+// когда придёт следующее значение. Конец ввода - клиент закрывает запись (shutdown(SHUT_WR)); ответ читается до конца.
+// В спуле запрос - файл NAME.job; он переименовывается в NAME.run, ответ появляется в NAME.out.
+// Ответ: строка "status: ok" / "status: error" / "status: compile-error" / "status: limit" (исчерпаны
+// --max-instructions или --max-time), затем вывод программы и сообщение об ошибке.
+//
+// Метрики в формате Prometheus: --metrics-socket=PATH (HTTP через Unix-сокет: curl --unix-socket PATH http://localhost/metrics)
+// и/или --metrics-file=PATH (файл переписывается раз в секунду - для textfile collector у node_exporter).
+// Одинаковые программы компилируются один раз: кэш на --cache=N программ (по умолчанию 256, 0 - без кэша).
+//
+// Нагрузка и задержки: python3 bench/service_load.py PATH
+#include <sstream>
+#include <chrono>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "scheduler.h"
+#include "metrics.h"
+#include "interpreter.h"
+using namespace std;
+using namespace translator::detail;
+
+MetricsRegistry metrics;
+
+// Скомпилированная программа; неизменна, её делят все задания с тем же текстом
+struct CompiledProgram
+{
+    vector<OPSElement> ops_code;
+    FloatFormat float_format;
+};
+
+// Последние capacity успешно скомпилированных программ по тексту; вытесняется давно не использованная
+class CompileCache
+{
+private:
+    using Entry = pair<string, shared_ptr<const CompiledProgram>>;
+    mutex cache_mutex;
+    size_t capacity;
+    list<Entry> recent; // В начале - последняя использованная
+    unordered_map<string, list<Entry>::iterator> by_text;
+
+public:
+    explicit CompileCache(size_t size) : capacity(size) {}
+
+    shared_ptr<const CompiledProgram> find(const string &text)
+    {
+        lock_guard<mutex> lock(cache_mutex);
+        auto found = by_text.find(text);
+        if (found == by_text.end())
+            return nullptr;
+        recent.splice(recent.begin(), recent, found->second);
+        return found->second->second;
+    }
+    void insert(const string &text, shared_ptr<const CompiledProgram> program)
+    {
+        if (capacity == 0)
+            return;
+        lock_guard<mutex> lock(cache_mutex);
+        if (by_text.count(text))
+            return; // Её уже скомпилировал другой поток
+        recent.emplace_front(text, move(program));
+        by_text[text] = recent.begin();
+        if (recent.size() > capacity)
+        {
+            by_text.erase(recent.back().first);
+            recent.pop_back();
+        }
+    }
+};
+
+// Готовые ответы клиентам сокета. Поток пула только кладёт ответ сюда и будит главный цикл через pipe; пишет в
+// неблокирующий сокет главный поток, по мере POLLOUT. Клиент, не читающий ответ, не занимает поток пула.
+class ReplyQueue
+{
+private:
+    mutex queue_mutex;
+    vector<pair<int, string>> ready; // Сокет клиента и ответ
+    int wake[2] = {-1, -1};          // Чтение - в poll главного цикла
+
+public:
+    ReplyQueue()
+    {
+        if (::pipe(wake) == 0)
+            for (int fd : wake)
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    ~ReplyQueue()
+    {
+        for (int fd : wake)
+            if (fd >= 0)
+                ::close(fd);
+    }
+    ReplyQueue(const ReplyQueue &) = delete;
+    ReplyQueue &operator=(const ReplyQueue &) = delete;
+
+    int fd() const { return wake[0]; }
+    void push(int client, string text)
+    {
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            ready.emplace_back(client, move(text));
+        }
+        char byte = 0;
+        while (::write(wake[1], &byte, 1) < 0 && errno == EINTR) // EAGAIN: pipe полон, главный цикл и так проснётся
+        {
+        }
+    }
+    vector<pair<int, string>> take()
+    {
+        char drain[256];
+        while (::read(wake[0], drain, sizeof(drain)) > 0)
+        {
+        }
+        lock_guard<mutex> lock(queue_mutex);
+        return move(ready);
+    }
+};
+
+struct ServiceOptions
+{
+    string socket_path;
+    string spool_dir;
+    unsigned threads;
+    size_t slice;                // Инструкций за отрезок, 0 - выполнять до конца
+    RunLimits limits;            // На каждую программу: --max-instructions=N, --max-time=MS
+    const OptimizerOptions *optimizer; // nullptr - без оптимизации
+    CompileCache *cache;
+    ReplyQueue *replies;
+    string metrics_socket;       // --metrics-socket=PATH
+    string metrics_file;         // --metrics-file=PATH
+};
+
+// Одна программа на всём пути: запрос -> компиляция -> отрезки выполнения (и ожидания ввода) -> ответ
+struct Job
+{
+    int client;             // Сокет клиента, -1 для спула
+    string spool_path;      // NAME.run для спула
+    string request;         // Текст программы; для сокета копится до строки "%%" или конца ввода
+    bool submitted = false; // Программа отдана пулу (только главный поток)
+
+    shared_ptr<const CompiledProgram> program;
+    string output_text;
+    unique_ptr<OutputBuffer> output;
+    unique_ptr<RuntimeIO> io;
+    unique_ptr<Interpreter> inter;
+
+    // Ввод пополняет главный поток, читает программа на пуле - всё ниже под input_mutex
+    mutex input_mutex;
+    InputReader input{','};
+    bool waiting = false; // Программа ждёт ввода и снята с пула: её вернёт главный поток
+
+    // Для метрик (только поток, выполняющий отрезок)
+    size_t counted_instructions = 0;
+    chrono::nanoseconds run_time{0};
+};
+
+// read() не трогает недописанное значение: пока целого слова нет, выполнение приостанавливается
+class ServiceIO : public StreamIO
+{
+private:
+    Job &job;
+
+public:
+    ServiceIO(OutputBuffer &out, Job &owner) : StreamIO(out, owner.input), job(owner) {}
+
+    ReadStatus read(const string &name, variant<int, float, string> &value, string &error) override
+    {
+        lock_guard<mutex> lock(job.input_mutex);
+        if (!job.input.ready())
+            return ReadStatus::Pending;
+        return StreamIO::read(name, value, error);
+    }
+};
+
+volatile sig_atomic_t stop_requested = 0;
+
+void requestStop(int)
+{
+    stop_requested = 1;
+}
+
+bool writeAll(int fd, const string &text)
+{
+    size_t done = 0;
+    while (done < text.size())
+    {
+        ssize_t written = ::write(fd, text.data() + done, text.size() - done);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        done += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool readAll(int fd, string &text)
+{
+    char block[1 << 16];
+    for (;;)
+    {
+        ssize_t got = ::read(fd, block, sizeof(block));
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+            return false;
+        if (got == 0)
+            return true;
+        text.append(block, static_cast<size_t>(got));
+    }
+}
+
+// Ответ, который главный поток дописывает в неблокирующий сокет клиента
+struct Reply
+{
+    string text;
+    size_t sent = 0;
+};
+
+// Пишет, сколько примет сокет. true - ответ отправлен целиком или клиент ушёл: сокет можно закрывать
+bool sendReply(int fd, Reply &reply)
+{
+    while (reply.sent < reply.text.size())
+    {
+        ssize_t written = ::write(fd, reply.text.data() + reply.sent, reply.text.size() - reply.sent);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return false;
+        if (written <= 0)
+            return true;
+        reply.sent += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void finishJob(const ServiceOptions &options, Job &job, const string &status, const string &body)
+{
+    string response = "status: " + status + "\n" + body;
+    metrics.add(status == "ok" ? Metric::FinishedOk : status == "limit" ? Metric::FinishedLimit
+                                                  : status == "compile-error" ? Metric::FinishedCompileError
+                                                                              : Metric::FinishedError);
+    metrics.add(Metric::OutputBytes, response.size());
+    if (job.client >= 0)
+    {
+        options.replies->push(job.client, move(response)); // Сокет закроет главный поток, дописав ответ
+        return;
+    }
+    // Ответ спула появляется целиком: сначала временный файл, затем переименование
+    string base = job.spool_path.substr(0, job.spool_path.size() - 4);
+    string temp = base + ".out.tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0)
+    {
+        writeAll(fd, response);
+        ::close(fd);
+        ::rename(temp.c_str(), (base + ".out").c_str());
+    }
+    ::unlink(job.spool_path.c_str());
+}
+
+// Один отрезок работы; true - программу нужно продолжить
+bool stepJob(Job &job, const ServiceOptions &options)
+{
+    if (!job.inter)
+    {
+        // Первый отрезок - компиляция или программа из кэша; ввод после "%%" уже передан в job.input
+        job.program = options.cache->find(job.request);
+        metrics.add(job.program ? Metric::CacheHits : Metric::CacheMisses);
+        if (!job.program)
+        {
+            auto compiled = make_shared<CompiledProgram>();
+            ostringstream messages;
+            if (!compileSource(job.request, compiled->ops_code, compiled->float_format, messages, options.optimizer))
+            {
+                metrics.add(Metric::CompileErrors);
+                finishJob(options, job, "compile-error", messages.str());
+                return false;
+            }
+            metrics.add(Metric::ScriptsCompiled);
+            options.cache->insert(job.request, compiled);
+            job.program = move(compiled);
+        }
+        job.output = make_unique<OutputBuffer>(job.output_text, job.program->float_format);
+        job.io = make_unique<ServiceIO>(*job.output, job);
+        job.inter = make_unique<Interpreter>(job.program->ops_code);
+        job.inter->start(*job.io, options.limits);
+        return true;
+    }
+    auto slice_start = chrono::steady_clock::now();
+    RunStatus status = job.inter->resume(options.slice);
+    job.run_time += chrono::steady_clock::now() - slice_start;
+    metrics.add(Metric::Instructions, job.inter->instructions() - job.counted_instructions);
+    job.counted_instructions = job.inter->instructions();
+    if (status == RunStatus::Yielded)
+        return true;
+    if (status == RunStatus::NeedsInput)
+    {
+        // Ввод мог прийти, пока отрезок заканчивался; иначе ждём без потока
+        lock_guard<mutex> lock(job.input_mutex);
+        if (job.input.ready())
+            return true;
+        job.waiting = true;
+        return false;
+    }
+    metrics.observeRun(job.run_time);
+    if (status != RunStatus::Finished)
+        metrics.runtimeError(runtimeErrorKind(job.inter->error()));
+    if (status == RunStatus::Finished)
+        finishJob(options, job, "ok", job.output_text);
+    else if (status == RunStatus::LimitExceeded)
+        finishJob(options, job, "limit", job.output_text + job.inter->error() + "\n");
+    else
+        finishJob(options, job, "error", job.output_text + job.inter->error() + "\n");
+    return false;
+}
+
+void submitJob(WorkStealingPool &pool, const ServiceOptions &options, shared_ptr<Job> job)
+{
+    pool.submit([job, &options]() { return stepJob(*job, options); });
+}
+
+// Делит запрос на программу и ввод по первой строке, состоящей только из "%%" (в том числе самой первой: программа
+// пуста); "%%x" - обычная строка программы. false - такая строка ещё не пришла целиком (и ввод не закончен).
+bool splitRequest(Job &job, bool input_closed)
+{
+    const string &request = job.request;
+    size_t split = string::npos;
+    size_t input_begin = request.size();
+    for (size_t line = 0; line < request.size();)
+    {
+        size_t end = request.find('\n', line);
+        if (end == string::npos && !input_closed)
+            break; // Последняя строка может ещё дописываться: "%%" станет "%%x"
+        size_t length = (end == string::npos ? request.size() : end) - line;
+        if (length > 2 && request[line + length - 1] == '\r')
+            --length;
+        if (length == 2 && request.compare(line, 2, "%%") == 0)
+        {
+            split = line;
+            input_begin = end == string::npos ? request.size() : end + 1;
+            break;
+        }
+        if (end == string::npos)
+            break;
+        line = end + 1;
+    }
+    if (split == string::npos && !input_closed)
+        return false;
+    {
+        lock_guard<mutex> lock(job.input_mutex);
+        job.input.append(request.data() + input_begin, request.size() - input_begin);
+        if (input_closed)
+            job.input.finish();
+    }
+    job.request.resize(min(split, request.size()));
+    return true;
+}
+
+// Очередная порция из сокета клиента (closed - клиент закрыл запись). true - сокет больше не читаем.
+bool receiveInput(WorkStealingPool &pool, const ServiceOptions &options, const shared_ptr<Job> &job, const char *text,
+                  size_t size, bool closed)
+{
+    metrics.add(Metric::InputBytes, size);
+    if (!job->submitted)
+    {
+        job->request.append(text, size);
+        if (splitRequest(*job, closed))
+        {
+            job->submitted = true;
+            submitJob(pool, options, job);
+        }
+        text = nullptr;
+        size = 0;
+    }
+    bool resume = false;
+    {
+        lock_guard<mutex> lock(job->input_mutex);
+        if (size > 0)
+            job->input.append(text, size);
+        if (closed)
+            job->input.finish();
+        if (job->waiting && job->input.ready())
+        {
+            job->waiting = false;
+            resume = true;
+        }
+    }
+    if (resume)
+        submitJob(pool, options, job);
+    return closed;
+}
+
+int openSocket(const string &path)
+{
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        cerr << "Socket path is too long: " << path << endl;
+        return -1;
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+    ::unlink(path.c_str()); // Сокет от прошлого запуска
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || ::listen(fd, 256) < 0)
+    {
+        cerr << "Cannot listen on " << path << endl;
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Забирает новые NAME.job из спула: переименование в NAME.run не даёт взять файл дважды
+void scanSpool(WorkStealingPool &pool, const ServiceOptions &options)
+{
+    DIR *dir = ::opendir(options.spool_dir.c_str());
+    if (!dir)
+        return;
+    while (dirent *entry = ::readdir(dir))
+    {
+        string name = entry->d_name;
+        if (name.size() <= 4 || name.compare(name.size() - 4, 4, ".job") != 0)
+            continue;
+        string base = options.spool_dir + "/" + name.substr(0, name.size() - 4);
+        string running = base + ".run";
+        if (::rename((base + ".job").c_str(), running.c_str()) < 0)
+            continue;
+        auto job = make_shared<Job>();
+        job->client = -1;
+        job->spool_path = running;
+        int fd = ::open(running.c_str(), O_RDONLY);
+        if (fd < 0 || !readAll(fd, job->request))
+        {
+            if (fd >= 0)
+                ::close(fd);
+            finishJob(options, *job, "error", "Cannot read " + running + "\n");
+            continue;
+        }
+        ::close(fd);
+        metrics.add(Metric::InputBytes, job->request.size());
+        splitRequest(*job, true);
+        job->submitted = true;
+        submitJob(pool, options, job);
+    }
+    ::closedir(dir);
+}
+
+// Подключение к --metrics-socket. Клиенты ждут в poll главного цикла вместе с остальными сокетами: молчащий клиент
+// не задерживает приём программ, а тот, кто не прислал запрос за metrics_request_timeout, закрывается
+struct MetricsRequest
+{
+    string text;
+    chrono::steady_clock::time_point accepted;
+};
+
+const chrono::seconds metrics_request_timeout(10);
+
+// Дочитывает HTTP-запрос (сам он не разбирается: ответ один на любой запрос). Ответ - когда пришла пустая строка
+// после заголовков или клиент закрыл запись: тогда закрытие сокета не оборвёт клиента, ещё пишущего запрос.
+// true - пора отвечать
+bool readMetricsRequest(int fd, MetricsRequest &request)
+{
+    char block[4096];
+    for (;;)
+    {
+        ssize_t got = ::recv(fd, block, sizeof(block), 0);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return false;
+        if (got <= 0)
+            return true;
+        request.text.append(block, static_cast<size_t>(got));
+        if (request.text.find("\r\n\r\n") != string::npos || request.text.find("\n\n") != string::npos ||
+            request.text.size() > 65536)
+            return true;
+    }
+}
+
+// HTTP, чтобы снимать curl и прокси Prometheus
+string metricsResponse()
+{
+    string body = metrics.scrape();
+    return "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " + to_string(body.size()) +
+           "\r\nConnection: close\r\n\r\n" + body;
+}
+
+// Файл метрик появляется целиком: сначала временный файл, затем переименование
+void writeMetricsFile(const string &path)
+{
+    string temp = path + ".tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return;
+    bool written = writeAll(fd, metrics.scrape());
+    ::close(fd);
+    if (written)
+        ::rename(temp.c_str(), path.c_str());
+}
+
+// Забирает готовые ответы пула: сокет больше не читается, ответ пишется сразу, остаток - по POLLOUT
+void takeReplies(ReplyQueue &replies, map<int, shared_ptr<Job>> &readers, map<int, Reply> &writers)
+{
+    for (auto &ready : replies.take())
+    {
+        readers.erase(ready.first); // Ввод после ответа программе уже не нужен
+        Reply reply{move(ready.second)};
+        if (sendReply(ready.first, reply))
+            ::close(ready.first);
+        else
+            writers[ready.first] = move(reply);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    ServiceOptions options;
+    options.threads = thread::hardware_concurrency();
+    options.slice = 10000;
+    options.optimizer = nullptr;
+    OptimizerOptions optimizer_options;
+    size_t cache_size = 256;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.compare(0, 9, "--socket=") == 0)
+            options.socket_path = arg.substr(9);
+        else if (arg.compare(0, 8, "--spool=") == 0)
+            options.spool_dir = arg.substr(8);
+        else if (arg.compare(0, 10, "--threads=") == 0)
+            options.threads = static_cast<unsigned>(atoi(arg.c_str() + 10));
+        else if (arg.compare(0, 8, "--slice=") == 0)
+            options.slice = static_cast<size_t>(atoll(arg.c_str() + 8));
+        else if (arg.compare(0, 19, "--max-instructions=") == 0)
+            options.limits.max_instructions = static_cast<size_t>(atoll(arg.c_str() + 19));
+        else if (arg.compare(0, 11, "--max-time=") == 0)
+            options.limits.max_time = chrono::milliseconds(atoll(arg.c_str() + 11));
+        else if (arg == "-O")
+            options.optimizer = &optimizer_options;
+        else if (arg.compare(0, 8, "--cache=") == 0)
+            cache_size = static_cast<size_t>(atoll(arg.c_str() + 8));
+        else if (arg.compare(0, 17, "--metrics-socket=") == 0)
+            options.metrics_socket = arg.substr(17);
+        else if (arg.compare(0, 15, "--metrics-file=") == 0)
+            options.metrics_file = arg.substr(15);
+        else
+        {
+            cerr << "Unknown argument: " << arg << endl;
+            return 1;
+        }
+    }
+    if (options.socket_path.empty() && options.spool_dir.empty())
+    {
+        cerr << "Usage: translator-service --socket=PATH | --spool=DIR [--threads=N] [--slice=N] [--max-instructions=N] [--max-time=MS] [-O]"
+                " [--cache=N] [--metrics-socket=PATH] [--metrics-file=PATH]" << endl;
+        return 1;
+    }
+    CompileCache cache(cache_size);
+    options.cache = &cache;
+    ReplyQueue replies;
+    options.replies = &replies;
+
+    signal(SIGPIPE, SIG_IGN); // Клиент может уйти, не дочитав ответ
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+
+    int listener = -1;
+    if (!options.socket_path.empty() && (listener = openSocket(options.socket_path)) < 0)
+        return 1;
+    int metrics_listener = -1;
+    if (!options.metrics_socket.empty() && (metrics_listener = openSocket(options.metrics_socket)) < 0)
+        return 1;
+    if (replies.fd() < 0)
+    {
+        cerr << "Cannot create a pipe" << endl;
+        return 1;
+    }
+    cerr << "Service: " << max(1u, options.threads) << " threads, slice " << options.slice << " instructions" << endl;
+    map<int, Reply> writers; // Сокеты, в которые ещё дописываются ответы (программам и метрик)
+    vector<pollfd> polled;
+    {
+        WorkStealingPool pool(options.threads);
+        map<int, shared_ptr<Job>> readers; // Сокеты, из которых ещё идут программа или ввод
+        map<int, MetricsRequest> metrics_readers;
+        char block[1 << 16];
+        auto last_scan = chrono::steady_clock::now() - chrono::seconds(1);
+        auto last_metrics = last_scan;
+        while (!stop_requested)
+        {
+            polled.clear();
+            polled.push_back(pollfd{replies.fd(), POLLIN, 0});
+            if (listener >= 0)
+                polled.push_back(pollfd{listener, POLLIN, 0});
+            if (metrics_listener >= 0)
+                polled.push_back(pollfd{metrics_listener, POLLIN, 0});
+            for (const auto &reader : readers)
+                polled.push_back(pollfd{reader.first, POLLIN, 0});
+            for (const auto &reader : metrics_readers)
+                polled.push_back(pollfd{reader.first, POLLIN, 0});
+            for (const auto &writer : writers)
+                polled.push_back(pollfd{writer.first, POLLOUT, 0});
+            if (::poll(polled.data(), polled.size(), 100) > 0)
+            {
+                for (const pollfd &ready : polled)
+                {
+                    if (!ready.revents)
+                        continue;
+                    if (ready.fd == replies.fd())
+                    {
+                        takeReplies(replies, readers, writers);
+                        continue;
+                    }
+                    if (ready.fd == metrics_listener)
+                    {
+                        int client = ::accept(metrics_listener, nullptr, nullptr);
+                        if (client < 0)
+                            continue;
+                        ::fcntl(client, F_SETFL, ::fcntl(client, F_GETFL) | O_NONBLOCK);
+                        metrics_readers[client].accepted = chrono::steady_clock::now();
+                        continue;
+                    }
+                    if (ready.fd == listener)
+                    {
+                        int client = ::accept(listener, nullptr, nullptr);
+                        if (client < 0)
+                            continue;
+                        ::fcntl(client, F_SETFL, ::fcntl(client, F_GETFL) | O_NONBLOCK);
+                        auto job = make_shared<Job>();
+                        job->client = client;
+                        readers[client] = job;
+                        continue;
+                    }
+                    auto writer = writers.find(ready.fd);
+                    if (writer != writers.end())
+                    {
+                        if (sendReply(ready.fd, writer->second))
+                        {
+                            ::close(ready.fd);
+                            writers.erase(writer);
+                        }
+                        continue;
+                    }
+                    auto metrics_reader = metrics_readers.find(ready.fd);
+                    if (metrics_reader != metrics_readers.end())
+                    {
+                        if (!readMetricsRequest(ready.fd, metrics_reader->second))
+                            continue;
+                        metrics_readers.erase(metrics_reader);
+                        Reply reply{metricsResponse()};
+                        if (sendReply(ready.fd, reply))
+                            ::close(ready.fd);
+                        else
+                            writers[ready.fd] = move(reply);
+                        continue;
+                    }
+                    // Сокет мог перейти к writers (или закрыться) выше в этом же проходе
+                    auto reader = readers.find(ready.fd);
+                    if (reader == readers.end())
+                        continue;
+                    ssize_t got = ::recv(ready.fd, block, sizeof(block), 0);
+                    if (got < 0 && (errno == EAGAIN || errno == EINTR))
+                        continue;
+                    bool closed = got <= 0;
+                    if (receiveInput(pool, options, reader->second, block, closed ? 0 : static_cast<size_t>(got), closed))
+                        readers.erase(reader); // Сокет закроется, когда уйдёт ответ
+                }
+            }
+            for (auto reader = metrics_readers.begin(); reader != metrics_readers.end();)
+            {
+                if (chrono::steady_clock::now() - reader->second.accepted < metrics_request_timeout)
+                {
+                    ++reader;
+                    continue;
+                }
+                ::close(reader->first);
+                reader = metrics_readers.erase(reader);
+            }
+            if (!options.spool_dir.empty() && chrono::steady_clock::now() - last_scan >= chrono::milliseconds(100))
+            {
+                scanSpool(pool, options);
+                last_scan = chrono::steady_clock::now();
+            }
+            if (!options.metrics_file.empty() && chrono::steady_clock::now() - last_metrics >= chrono::seconds(1))
+            {
+                writeMetricsFile(options.metrics_file);
+                last_metrics = chrono::steady_clock::now();
+            }
+        }
+        // Ввода больше не будет: ждущие программы завершатся ошибкой ввода, пул дорабатывает принятые
+        for (const auto &reader : readers)
+            receiveInput(pool, options, reader.second, nullptr, 0, true);
+        for (const auto &reader : metrics_readers)
+            ::close(reader.first);
+    }
+    // Пул доработал; оставшиеся ответы дописываются, но не дольше секунды - клиент может их и не читать
+    map<int, shared_ptr<Job>> no_readers;
+    takeReplies(replies, no_readers, writers);
+    auto give_up = chrono::steady_clock::now() + chrono::seconds(1);
+    while (!writers.empty() && chrono::steady_clock::now() < give_up)
+    {
+        polled.clear();
+        for (const auto &writer : writers)
+            polled.push_back(pollfd{writer.first, POLLOUT, 0});
+        if (::poll(polled.data(), polled.size(), 100) <= 0)
+            continue;
+        for (const pollfd &ready : polled)
+            if (ready.revents && sendReply(ready.fd, writers[ready.fd]))
+            {
+                ::close(ready.fd);
+                writers.erase(ready.fd);
+            }
+    }
+    for (const auto &writer : writers)
+        ::close(writer.first);
+    if (listener >= 0)
+    {
+        ::close(listener);
+        ::unlink(options.socket_path.c_str());
+    }
+    if (metrics_listener >= 0)
+    {
+        ::close(metrics_listener);
+        ::unlink(options.metrics_socket.c_str());
+    }
+    if (!options.metrics_file.empty())
+        writeMetricsFile(options.metrics_file); // Итог после того, как пул доработал
+    return 0;
+}
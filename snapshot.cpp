@@ -0,0 +1,130 @@
+#include "snapshot.h"
+#include <fstream>
+#include <cstring> // Для memcpy и memcmp
+
+namespace translator::detail
+{
+bool InterpreterState::save(const string &path) const
+{
+    ofstream out(path, ios::binary);
+    auto put = [&](uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+    };
+    auto put_string = [&](const string &text)
+    {
+        put(text.size(), 4);
+        out.write(text.data(), static_cast<streamsize>(text.size()));
+    };
+    auto put_value = [&](const variant<int, float, string> &value)
+    {
+        if (holds_alternative<string>(value))
+        {
+            put(2, 1);
+            put_string(get<string>(value));
+            return;
+        }
+        uint32_t bits;
+        if (holds_alternative<int>(value))
+            bits = static_cast<uint32_t>(get<int>(value));
+        else
+            memcpy(&bits, &get<float>(value), sizeof(bits));
+        put(holds_alternative<int>(value) ? 0 : 1, 1);
+        put(bits, 4);
+    };
+    out.write("OPSSNAP1", 8);
+    put(program_hash, 8);
+    put(program_counter, 8);
+    put(executed, 8);
+    put(stack.size(), 8);
+    for (const auto &value : stack)
+        put_value(value);
+    put(variables.size(), 8);
+    for (const auto &variable : variables)
+    {
+        put_string(variable.first);
+        put_value(variable.second);
+    }
+    return static_cast<bool>(out);
+}
+
+bool InterpreterState::load(const string &path, string &error)
+{
+    ifstream in(path, ios::binary);
+    if (!in)
+    {
+        error = "The snapshot file was not found: " + path;
+        return false;
+    }
+    in.seekg(0, ios::end);
+    uint64_t file_size = in ? static_cast<uint64_t>(in.tellg()) : 0;
+    in.seekg(0);
+    auto get_u = [&](size_t size)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i)
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(in.get())) << (8 * i);
+        return value;
+    };
+    // Длины из файла не больше самого файла: испорченный снимок не должен выделять гигабайты
+    auto get_string = [&](string &text)
+    {
+        uint64_t size = get_u(4);
+        if (!in || size > file_size)
+            return false;
+        text.resize(static_cast<size_t>(size));
+        in.read(&text[0], static_cast<streamsize>(size));
+        return static_cast<bool>(in);
+    };
+    auto get_value = [&](variant<int, float, string> &value)
+    {
+        uint64_t type = get_u(1);
+        if (type == 2)
+        {
+            string name;
+            if (!get_string(name))
+                return false;
+            value = move(name);
+            return true;
+        }
+        uint32_t bits = static_cast<uint32_t>(get_u(4));
+        if (type == 0)
+            value = static_cast<int>(bits);
+        else
+        {
+            float number;
+            memcpy(&number, &bits, sizeof(number));
+            value = number;
+        }
+        return type <= 1 && static_cast<bool>(in);
+    };
+    char magic[8];
+    if (!in.read(magic, 8) || memcmp(magic, "OPSSNAP1", 8) != 0)
+    {
+        error = "Not a snapshot file: " + path;
+        return false;
+    }
+    program_hash = get_u(8);
+    program_counter = static_cast<size_t>(get_u(8));
+    executed = static_cast<size_t>(get_u(8));
+    uint64_t count = get_u(8);
+    bool ok = static_cast<bool>(in) && count <= file_size;
+    stack.assign(ok ? static_cast<size_t>(count) : 0, 0);
+    for (auto &value : stack)
+        if (!(ok = get_value(value)))
+            break;
+    count = ok ? get_u(8) : 0;
+    ok = ok && in && count <= file_size;
+    variables.assign(ok ? static_cast<size_t>(count) : 0, {});
+    for (auto &variable : variables)
+        if (!(ok = get_string(variable.first) && get_value(variable.second)))
+            break;
+    if (!ok)
+    {
+        error = "The snapshot file is damaged: " + path;
+        return false;
+    }
+    return true;
+}
+} // namespace translator::detail
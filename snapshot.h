@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <variant>
+#include <utility>
+#include <cstdint>
+
+namespace translator::detail
+{
+using namespace std;
+
+// --- СНИМОК СОСТОЯНИЯ (--snapshot / --restore) ---
+// Всё, что нужно, чтобы продолжить выполнение с места: позиция в ОПС, стек, переменные и число выполненных инструкций.
+// Снимок привязан к ОПС по хешу (programHash), поэтому восстанавливается только в ту же программу с теми же -O и --unroll.
+// Восстановление - чтение файла и заполнение таблицы, без повторного выполнения пройденной части.
+//
+// Файл (числа little-endian): "OPSSNAP1", u64 хеш ОПС, u64 PC, u64 инструкций, u64 элементов стека и по элементу
+// значение, u64 переменных и по переменной строка имени и значение. Значение - u8 тип (0 - int, 1 - float, 2 - имя)
+// и 4 байта числа или строка; строка - u32 длина и байты.
+
+struct InterpreterState
+{
+    uint64_t program_hash = 0;
+    size_t program_counter = 0;
+    size_t executed = 0;
+    vector<variant<int, float, string>> stack;
+    vector<pair<string, variant<int, float, string>>> variables;
+
+    bool save(const string &path) const;
+    // false - файла нет или он не снимок; error объясняет
+    bool load(const string &path, string &error);
+};
+} // namespace translator::detail
@@ -0,0 +1,123 @@
+#include "stats.h"
+#include <iomanip>
+#include <new>     // Для bad_alloc, nothrow_t и align_val_t
+#include <cstdlib> // Для malloc, aligned_alloc и free
+#include <cstddef> // Для max_align_t
+
+namespace translator::detail
+{
+namespace allocations
+{
+atomic<bool> counting(false);
+atomic<size_t> count(0);
+atomic<size_t> bytes(0);
+
+// Все формы operator new: счёт и malloc, для выравнивания больше стандартного - aligned_alloc (размер кратен
+// выравниванию). nullptr - памяти нет; освобождаются все одинаково, через free()
+void *allocate(size_t size, size_t alignment)
+{
+    if (counting.load(memory_order_relaxed))
+    {
+        count.fetch_add(1, memory_order_relaxed);
+        bytes.fetch_add(size, memory_order_relaxed);
+    }
+    if (size == 0)
+        size = 1;
+    if (alignment <= alignof(max_align_t))
+        return malloc(size);
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void *allocateOrThrow(size_t size, size_t alignment)
+{
+    if (void *memory = allocate(size, alignment))
+        return memory;
+    throw bad_alloc();
+}
+} // namespace allocations
+
+void RunStats::writeText(ostream &out) const
+{
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    double total_ms = 0;
+    size_t total_allocations = 0, total_bytes = 0;
+    out << "--- Stats ---\n"
+        << left << setw(12) << "phase" << right << setw(12) << "ms" << setw(12) << "allocs"
+        << setw(14) << "bytes" << "\n";
+    for (const Phase &phase : phases)
+    {
+        out << left << setw(12) << phase.name << right << fixed << setprecision(3) << setw(12)
+            << phase.ms << setw(12) << phase.allocations << setw(14) << phase.bytes << "\n";
+        total_ms += phase.ms;
+        total_allocations += phase.allocations;
+        total_bytes += phase.bytes;
+    }
+    out << left << setw(12) << "total" << right << setw(12) << total_ms << setw(12) << total_allocations
+        << setw(14) << total_bytes << "\n";
+    for (const auto &counter : counters)
+        out << counter.first << ": " << counter.second << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void RunStats::writeJson(ostream &out) const
+{
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    double total_ms = 0;
+    out << "{\n  \"phases\": [";
+    for (size_t i = 0; i < phases.size(); ++i)
+    {
+        const Phase &phase = phases[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << phase.name << "\", \"ms\": " << fixed << setprecision(3)
+            << phase.ms << ", \"allocations\": " << phase.allocations << ", \"bytes\": " << phase.bytes << "}";
+        total_ms += phase.ms;
+    }
+    out << "\n  ],\n  \"total_ms\": " << total_ms << ",\n  \"counters\": {";
+    for (size_t i = 0; i < counters.size(); ++i)
+        out << (i ? ",\n" : "\n") << "    \"" << counters[i].first << "\": " << counters[i].second;
+    out << "\n  }\n}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+} // namespace translator::detail
+
+using namespace translator::detail;
+
+void *operator new(size_t size) { return allocations::allocateOrThrow(size, 0); }
+void *operator new[](size_t size) { return allocations::allocateOrThrow(size, 0); }
+void *operator new(size_t size, const nothrow_t &) noexcept { return allocations::allocate(size, 0); }
+void *operator new[](size_t size, const nothrow_t &) noexcept { return allocations::allocate(size, 0); }
+void *operator new(size_t size, align_val_t alignment) { return allocations::allocateOrThrow(size, static_cast<size_t>(alignment)); }
+void *operator new[](size_t size, align_val_t alignment) { return allocations::allocateOrThrow(size, static_cast<size_t>(alignment)); }
+void *operator new(size_t size, align_val_t alignment, const nothrow_t &) noexcept
+{
+    return allocations::allocate(size, static_cast<size_t>(alignment));
+}
+void *operator new[](size_t size, align_val_t alignment, const nothrow_t &) noexcept
+{
+    return allocations::allocate(size, static_cast<size_t>(alignment));
+}
+
+// Память от всех форм new выше - malloc или aligned_alloc, поэтому free() верен. GCC встраивает delete в места
+// вызова и, видя free() для указателя из operator new, предупреждает (-Wmismatched-new-delete) - здесь зря.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete[](void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+void operator delete[](void *memory, size_t) noexcept { free(memory); }
+void operator delete(void *memory, const nothrow_t &) noexcept { free(memory); }
+void operator delete[](void *memory, const nothrow_t &) noexcept { free(memory); }
+void operator delete(void *memory, align_val_t) noexcept { free(memory); }
+void operator delete[](void *memory, align_val_t) noexcept { free(memory); }
+void operator delete(void *memory, size_t, align_val_t) noexcept { free(memory); }
+void operator delete[](void *memory, size_t, align_val_t) noexcept { free(memory); }
+void operator delete(void *memory, align_val_t, const nothrow_t &) noexcept { free(memory); }
+void operator delete[](void *memory, align_val_t, const nothrow_t &) noexcept { free(memory); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
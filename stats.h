@@ -0,0 +1,78 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+
+namespace translator::detail
+{
+using namespace std;
+
+// --- СТАТИСТИКА ЗАПУСКА (--stats) ---
+// Время, число выделений памяти и их байты по этапам (чтение файла, лексер, парсер, оптимизатор, печать ОПС,
+// разрешение меток, выполнение) и счётчики: лексемы, элементы ОПС, метки, глубина стека, переменные.
+// Печатается текстом в stderr (--stats) и в JSON для дашбордов (--stats-json=FILE).
+// Выделения считает замена глобального operator new, поэтому stats.cpp собирается только в interpreter, а не в библиотеку:
+// у исполняемого файла может быть лишь одна такая замена, а библиотеке она не нужна.
+
+namespace allocations
+{
+extern atomic<bool> counting; // Считать только с --stats: иначе потоки --records спорили бы за счётчики
+extern atomic<size_t> count;
+extern atomic<size_t> bytes;
+} // namespace allocations
+
+class RunStats
+{
+private:
+    struct Phase
+    {
+        string name;
+        double ms;
+        size_t allocations;
+        size_t bytes;
+    };
+    bool enabled;
+    vector<Phase> phases;
+    vector<pair<string, size_t>> counters; // В порядке добавления
+    chrono::steady_clock::time_point phase_start;
+    size_t count_start, bytes_start;
+
+public:
+    explicit RunStats(bool on) : enabled(on), count_start(0), bytes_start(0)
+    {
+        allocations::counting.store(on);
+    }
+    bool on() const { return enabled; }
+
+    // Этапы идут друг за другом: begin() одного, end(), begin() следующего
+    void begin(const string &name)
+    {
+        if (!enabled)
+            return;
+        phases.push_back({name, 0.0, 0, 0});
+        count_start = allocations::count.load(memory_order_relaxed);
+        bytes_start = allocations::bytes.load(memory_order_relaxed);
+        phase_start = chrono::steady_clock::now();
+    }
+    void end()
+    {
+        if (!enabled || phases.empty())
+            return;
+        Phase &phase = phases.back();
+        phase.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - phase_start).count();
+        phase.allocations = allocations::count.load(memory_order_relaxed) - count_start;
+        phase.bytes = allocations::bytes.load(memory_order_relaxed) - bytes_start;
+    }
+    void count(const string &name, size_t value)
+    {
+        if (enabled)
+            counters.push_back({name, value});
+    }
+
+    void writeText(ostream &out) const;
+    // Имена этапов и счётчиков - идентификаторы без кавычек и '\', экранировать нечего
+    void writeJson(ostream &out) const;
+};
+} // namespace translator::detail
@@ -1,787 +1,816 @@
-#include <iostream>
-#include <string>
-#include <fstream>
-#include <unordered_map>
-#include <vector>
-#include <cctype>    // For isalpha, isdigit, isalnum, isspace
-#include <stdexcept> // For std::runtime_error, std::invalid_argument, std::out_of_range
-#include <variant>
-#include <iomanip> // For std::fixed, std::setprecision
-#include "lexer.cpp"
-// --- ОПРЕДЕЛЕНИЕ ФОРМАТА ОПС (Задача 6) ---
-// Перечисление для кодов операций ОПС
-enum class OPSCode
-{
-    // Операнды (специальные маркеры, чтобы знать, что находится в value)
-    OP_INT_CONST,   // value is int_
-    OP_FLOAT_CONST, // value is flo_
-    OP_IDENT,       // value is str_
-
-    // Арифметические
-    OP_ADD,
-    OP_SUB,
-    OP_MUL,
-    OP_DIV,
-
-    // Сравнения
-    OP_LS,
-    OP_LE,
-    OP_GS,
-    OP_GE,
-    OP_EQ,
-    OP_NE,
-
-    // Управление потоком
-    OP_JF,  // Условный переход (Jump if Zero)
-    OP_JMP, // Безусловный переход
-
-    // Память
-    OP_ASSIGN, // Присваивание
-
-    // Ввод/Вывод
-    OP_READ,
-    OP_PRINT,
-
-    OP_ERROR,
-
-    // Метки (для переходов)
-    OP_LABEL // value is int_ (индекс в векторе OPS)
-};
-
-// Структура для одного элемента в последовательности ОПС
-struct OPSElement
-{
-    OPSCode code; // Код операции или тип операнда
-
-    // Значение элемента. Используем variant для гибкости.
-    std::variant<int, float, std::string, size_t> value; // int/float для констант, string для имен переменных, size_t для адресов меток (индексов в векторе)
-
-    OPSElement(OPSCode c, int v) : code(c), value(v) {}
-    OPSElement(OPSCode c, float v) : code(c), value(v) {}
-    OPSElement(OPSCode c, const std::string &v) : code(c), value(v) {}
-    OPSElement(OPSCode c, size_t v) : code(c), value(v) {}
-    OPSElement(OPSCode c) : code(c) {} // Для операций без явного значения (JMP, JF, +, =, etc.)
-};
-
-// --- ГЕНЕРАЦИЯ ОПС (Задача 4) ---
-
-// Вспомогательная функция для добавления элемента в ОПС
-// Перегружена для разных типов значений
-
-// Вспомогательная функция для генерации уникальных меток
-size_t label_counter = 0;
-std::string NewLabel()
-{
-    return "L" + std::to_string(label_counter++);
-}
-
-// --- СИНТАКСИЧЕСКИЙ АНАЛИЗАТОР (ПАРСЕР) ---
-// (Рекурсивный спуск с генерацией ОПС)
-
-class Parser
-{
-private:
-    Lexer &lexer;       // Ссылка на лексер
-    bool hasError;      // Флаг ошибки парсинга
-    Token currentToken; // Текущий токен от лексера
-    std::vector<OPSElement> &ops_code;
-
-    // Вспомогательные функции
-    void expect(TokenType expectedType, const std::string &errorMessage);
-    void expect(const std::string &expectedValue, const std::string &errorMessage);
-    void consume();
-    void error(const std::string &message);
-
-    // Функции для каждого нетерминала грамматики
-    void Start();
-    void StatementList();
-    void Statement();
-    void Assignment();
-    void Expression();
-    void U(); // Для + и - хвоста выражения
-    void Term();
-    void V(); // Для * и / хвоста выражения
-    void Factor();
-    void Condition();
-    // COMPOP не нужна как отдельная функция
-    void Ifelse();
-    void Loop();
-    void InOutput(); // Объединяет Input и Output
-    void Input();
-    void Output();
-    void AddToOPS(const OPSElement &element);
-    // EmptyStatement не нужна как отдельная функция
-
-    // Вспомогательная функция для получения OPSCode из строки оператора
-    OPSCode getOPSCode(const std::string &op_symbol);
-
-public:
-    Parser(Lexer &lexer, vector<OPSElement> &ops_code); // Конструктор
-    void parse();
-    bool hasSyntaxError() const { return hasError; }
-};
-
-// Конструктор парсера
-
-Parser::Parser(Lexer &lexer, vector<OPSElement> &ops_code) : lexer(lexer), hasError(false), currentToken(lexer.getNextToken()), ops_code(ops_code) {}
-
-void Parser::parse()
-{
-    // Проверяем, нет ли ошибок от лексера на первом токене
-    if (hasError)
-    {
-        std::cerr << "Parsing aborted due to initial lexical error." << std::endl;
-        return; // Прерываем парсинг, если лексер уже выдал ошибку
-    }
-    // Начинаем разбор с начального символа грамматики (START)
-    Start();
-
-    if (!hasError)
-    {
-        std::cout << "Parsing successful: Syntax is correct." << std::endl;
-        // !!! ЗДЕСЬ должен быть вызов функции для интерпретации сгенерированного OPS !!!
-        // interpret_ops(ops_code); // Пример вызова
-    }
-    else
-    {
-        std::cerr << "Parsing failed: Syntax errors found." << std::endl;
-    }
-}
-void Parser::AddToOPS(const OPSElement &element)
-{
-    ops_code.push_back(element);
-}
-// Получает следующий токен
-void Parser::consume()
-{
-    if (hasError)
-        return;
-    currentToken = lexer.getNextToken();
-}
-
-// Проверяет тип текущего токена и потребляет его
-void Parser::expect(TokenType expectedType, const std::string &errorMessage)
-{
-    if (hasError)
-        return;
-    if (currentToken.type == expectedType)
-    {
-        consume();
-        return;
-    }
-    error(errorMessage);
-    hasError = true;
-}
-
-// Проверяет значение (для операторов/разделителей/ключевых слов) текущего токена и потребляет его
-void Parser::expect(const std::string &expectedValue, const std::string &errorMessage)
-{
-    if (hasError)
-        return;
-
-    if ((currentToken.type == TokenType::OPERATOR ||
-         currentToken.type == TokenType::DELIMITER ||
-         currentToken.type == TokenType::KEYWORD) &&
-        currentToken.str_ == expectedValue)
-    {
-        consume();
-        return;
-    }
-
-    error(errorMessage);
-    hasError = true;
-}
-
-// Выводит сообщение об ошибке парсинга
-void Parser::error(const std::string &message)
-{
-    if (!hasError)
-    {
-        std::cerr << "Syntax Error at Row " << lexer.get_row() + 1 << ", Column " << lexer.get_column() + 1 << ": " << message << std::endl;
-        hasError = true;
-        // В реальном парсере здесь может быть логика восстановления после ошибки
-    }
-}
-
-// Вспомогательная функция для получения OPSCode из строки оператора
-OPSCode Parser::getOPSCode(const std::string &op_symbol)
-{
-    if (op_symbol == "+")
-        return OPSCode::OP_ADD;
-    if (op_symbol == "-")
-        return OPSCode::OP_SUB;
-    if (op_symbol == "*")
-        return OPSCode::OP_MUL;
-    if (op_symbol == "/")
-        return OPSCode::OP_DIV;
-    if (op_symbol == "<")
-        return OPSCode::OP_LS;
-    if (op_symbol == "<=")
-        return OPSCode::OP_LE;
-    if (op_symbol == ">")
-        return OPSCode::OP_GS;
-    if (op_symbol == ">=")
-        return OPSCode::OP_GE;
-    if (op_symbol == "==")
-        return OPSCode::OP_EQ;
-    if (op_symbol == "<>")
-        return OPSCode::OP_NE;
-    if (op_symbol == "=")
-        return OPSCode::OP_ASSIGN;
-    // ... добавьте другие операторы, если есть (AND, OR, NOT, etc.)
-    // Если оператор не найден, это внутренняя ошибка или ошибка лексера
-    std::cerr << "Internal Error: Unknown operator symbol '" << op_symbol << "' in getOPSCode." << std::endl;
-    return OPSCode::OP_ERROR; // Нужен специальный код ошибки, или бросить исключение.
-    // Добавляем фиктивный OP_ERROR в OPSCode enum.
-}
-
-// --- Реализация функций для нетерминалов (по вашей грамматике) ---
-
-// START -> STATEMENT_LIST EOF
-void Parser::Start()
-{
-    if (hasError)
-        return;
-    StatementList();
-}
-
-// STATEMENT_LIST -> STATEMENT STATEMENT_LIST | ε
-void Parser::StatementList()
-{
-    if (hasError)
-        return;
-
-    // Проверяем, есть ли начало оператора
-    if (currentToken.type == TokenType::ID ||
-        (currentToken.type == TokenType::KEYWORD &&
-         (currentToken.str_ == "if" || currentToken.str_ == "while" || currentToken.str_ == "read" || currentToken.str_ == "print")) ||
-        (currentToken.type == TokenType::DELIMITER && currentToken.str_ == ";"))
-    {
-        // Разбираем один оператор
-        Statement();
-        // Рекурсивно разбираем остаток списка операторов
-        StatementList();
-    }
-    // Если нет начала оператора, это ε-случай (ничего не делаем)
-}
-
-// STATEMENT -> ASSIGNMENT SC | IFELSE SC | LOOP SC | INPUT SC | OUTPUT SC | SC
-void Parser::Statement()
-{
-    if (hasError)
-        return;
-
-    if (currentToken.type == TokenType::ID)
-    {
-        // Оператор присваивания
-        Assignment();
-        expect(";", "Expected ';' after assignment statement.");
-    }
-    else if (currentToken.type == TokenType::KEYWORD)
-    {
-        if (currentToken.str_ == "if")
-        {
-            Ifelse();
-        }
-        else if (currentToken.str_ == "while")
-        {
-            Loop();
-        }
-        else if (currentToken.str_ == "read" || currentToken.str_ == "print")
-        {
-            InOutput();
-        }
-        else
-        {
-            error("Syntax Error: Unexpected keyword '" + currentToken.str_ + "'.");
-            consume();
-        }
-        expect(";", "Expected ';' after control statement.");
-    }
-    else if (currentToken.type == TokenType::DELIMITER && currentToken.str_ == ";")
-    {
-        // Пустой оператор
-        expect(";", "Internal Parser Error: Expected ';'.");
-    }
-    else
-    {
-        error("Syntax Error: Expected start of a statement (ID, keyword, or ';'), but got token type " +
-              std::to_string(static_cast<int>(currentToken.type)));
-        consume();
-    }
-}
-
-// ASSIGNMENT -> ID ASSIGN EXPRESSION
-void Parser::Assignment()
-{
-    if (hasError)
-        return;
-    std::string var_name = currentToken.str_;
-    expect(TokenType::ID, "Expected identifier in assignment.");
-
-    if (hasError)
-        return;
-
-    expect("=", "Expected '=' in assignment.");
-    if (hasError)
-        return;
-
-    Expression(); // Generates OPS for the expression
-
-    // Semantic actions (after expression OPS is generated)
-    AddToOPS(OPSElement(OPSCode::OP_IDENT, var_name)); // Variable (where to assign)
-    AddToOPS(OPSElement(OPSCode::OP_ASSIGN));          // Assignment operator
-}
-
-// EXPRESSION -> TERM U
-void Parser::Expression()
-{
-    if (hasError)
-        return;
-    Term(); // Generates OPS for the first Term
-    U();    // Generates OPS for the rest (+/-)
-}
-
-// U -> ADD TERM U | SUB TERM U | ε
-void Parser::U()
-{
-    if (hasError)
-        return;
-    // Check for '+' or '-' operator
-    if (currentToken.type == TokenType::OPERATOR && (currentToken.str_ == "+" || currentToken.str_ == "-"))
-    {
-        std::string op_val = currentToken.str_;                        // Capture operator symbol
-        expect(op_val, "Internal Parser Error: Expected '+' or '-'."); // Consume the operator
-        if (hasError)
-            return;
-
-        Term(); // Generates OPS for the next Term
-
-        U(); // Recurse for the rest of the tail
-
-        // Semantic action (after operands and tail are parsed)
-        AddToOPS(OPSElement(getOPSCode(op_val))); // Add the operator to OPS
-    }
-    // Epsilon case (nothing to do) is implicit when the token is not '+' or '-'
-    // Follow set of U: {;, ), }, <, <=, >, >=, ==, <>, (AND, OR, NOT?), EOF}
-}
-
-// TERM -> FACTOR V
-void Parser::Term()
-{
-    if (hasError)
-        return;
-    Factor(); // Generates OPS for the Factor
-    V();      // Generates OPS for the rest (*, /)
-}
-
-// V -> MUL FACTOR V | DIV FACTOR V | ε
-void Parser::V()
-{
-    if (hasError)
-        return;
-    // Check for '*' or '/' operator
-    if (currentToken.type == TokenType::OPERATOR && (currentToken.str_ == "*" || currentToken.str_ == "/"))
-    {
-        std::string op_val = currentToken.str_;                        // Capture operator symbol
-        expect(op_val, "Internal Parser Error: Expected '*' or '/'."); // Consume the operator
-        if (hasError)
-            return;
-
-        Factor(); // Generates OPS for the next Factor
-
-        V(); // Recurse for the rest of the tail
-
-        // Semantic action (after operands and tail are parsed)
-        AddToOPS(OPSElement(getOPSCode(op_val))); // Add the operator to OPS
-    }
-    // Epsilon case is implicit
-    // Follow set of V: {+, -, ;, ), }, <, <=, >, >=, ==, <>, (AND, OR, NOT?), EOF}
-}
-
-// FACTOR -> ID | INT_CONST | FLOAT_CONST | L_BRACKET EXPRESSION R_BRACKET
-void Parser::Factor()
-{
-    if (hasError)
-        return;
-
-    if (currentToken.type == TokenType::DELIMITER && currentToken.str_ == "(")
-    {
-        expect("(", "Expected '(' in factor.");
-        Expression(); // Рекурсивно разбираем выражение внутри скобок
-        expect(")", "Expected ')' after expression in factor.");
-        return;
-
-        // Семантические действия: скобки только управляют порядком вычислений, не генерируют дополнительные команды
-    }
-    else if (currentToken.type == TokenType::ID)
-    {
-        AddToOPS(OPSElement(OPSCode::OP_IDENT, currentToken.str_));
-        expect(TokenType::ID, "Expected identifier in factor.");
-        return;
-    }
-    else if (currentToken.type == TokenType::INT_CONST)
-    {
-        AddToOPS(OPSElement(OPSCode::OP_INT_CONST, currentToken.int_));
-        expect(TokenType::INT_CONST, "Expected integer constant in factor.");
-        return;
-    }
-    else if (currentToken.type == TokenType::FLOAT_CONST)
-    {
-        AddToOPS(OPSElement(OPSCode::OP_FLOAT_CONST, currentToken.flo_));
-        expect(TokenType::FLOAT_CONST, "Expected float constant in factor.");
-        return;
-    }
-
-    else
-    {
-        error("Syntax Error: Expected identifier, number, or '(' in factor.");
-        consume();
-    }
-}
-
-// COMPOP -> LS | LE | GS | GE | EQ | NE
-// This non-terminal is handled directly within Condition function.
-
-// CONDITION -> EXPRESSION COMPOP EXPRESSION
-void Parser::Condition()
-{
-    if (hasError)
-        return;
-    Expression(); // Generates OPS for the left side of the comparison
-
-    // Check and consume the comparison operator
-    if (currentToken.type == TokenType::OPERATOR)
-    {
-        std::string op_val = currentToken.str_; // Capture operator symbol
-        if (op_val == "<" || op_val == "<=" || op_val == ">" || op_val == ">=" || op_val == "==" || op_val == "<>")
-        {
-            expect(op_val, "Internal Parser Error: Expected comparison operator."); // Consume the operator
-            if (hasError)
-                return;
-            Expression(); // Generates OPS for the right side of the comparison
-
-            // Semantic action (after both expressions are parsed)
-            AddToOPS(OPSElement(getOPSCode(op_val))); // Add the comparison operator to OPS
-        }
-        else
-        {
-            error("Syntax Error: Expected comparison operator (<, <=, >, >=, ==, <>), but got '" + op_val + "'.");
-            consume();
-        }
-    }
-    else
-    {
-        error("Syntax Error: Expected comparison operator after expression in condition.");
-        consume();
-    }
-}
-
-// IFELSE -> IF_STATEMENT L_BRACKET CONDITION R_BRACKET L_BODY STATEMENT_LIST R_BODY ELSE_STATEMENT L_BODY STATEMENT_LIST R_BODY
-//        | IF_STATEMENT L_BRACKET CONDITION R_BRACKET L_BODY STATEMENT_LIST R_BODY
-void Parser::Ifelse()
-{
-    if (hasError)
-        return;
-    expect("if", "Internal Parser Error: Expected 'if'."); // Keyword if
-    if (hasError)
-        return;
-    expect("(", "Expected '(' after 'if'.");
-    if (hasError)
-        return;
-    Condition(); // Generates OPS for the condition
-    expect(")", "Expected ')' after condition.");
-    if (hasError)
-        return;
-
-    // --- Semantic actions for the IF part ---
-    // After condition, generate JF jump based on condition result
-    std::string labelElse = NewLabel();                 // Label for the start of the else block (or end of if)
-    AddToOPS(OPSElement(OPSCode::OP_LABEL, labelElse)); // Add label reference to OPS
-    AddToOPS(OPSElement(OPSCode::OP_JF));               // Add JF command
-
-    expect("{", "Expected '{' for if body.");
-    if (hasError)
-        return;
-    StatementList(); // Generates OPS for the 'then' block
-    expect("}", "Expected '}' after if body.");
-    if (hasError)
-        return;
-    if (currentToken.type == TokenType::KEYWORD && currentToken.str_ == "else")
-    {
-        // --- Semantic actions for the ELSE part ---
-        // Before the else block, generate a JMP to skip the else block if 'if' was true
-        std::string labelEnd = NewLabel();                 // Label for the very end of if-else
-        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelEnd)); // Add label reference to OPS
-        AddToOPS(OPSElement(OPSCode::OP_JMP));             // Add JMP command
-
-        // Place the label for the start of the else block
-        //  AddToOPS(OPSElement(OPSCode::OP_LABEL, ":")); // Add label definition to OPS
-
-        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelElse + ":"));
-
-        expect("else", "Internal Parser Error: Expected 'else'."); // Keyword else
-        if (hasError)
-            return;
-        expect("{", "Expected '{' for else body.");
-        if (hasError)
-            return;
-        StatementList(); // Generates OPS for the 'else' block
-        expect("}", "Expected '}' after else body.");
-        if (hasError)
-            return;
-    }
-    AddToOPS(OPSElement(OPSCode::OP_LABEL, labelElse + ":")); // Add label definition to OPS
-}
-// LOOP -> WHILE_STATEMENT L_BRACKET CONDITION R_BRACKET L_BODY STATEMENT_LIST R_BODY
-//      | FOR_STATEMENT L_BRACKET STATEMENT CONDITION SC STATEMENT R_BRACKET L_BODY STATEMENT_LIST R_BODY
-void Parser::Loop()
-{
-    if (hasError)
-        return;
-    if (currentToken.type == TokenType::KEYWORD && currentToken.str_ == "while")
-    {
-        // --- Semantic actions for WHILE ---
-        std::string labelStart = NewLabel(); // Label for the start of condition check
-        std::string labelEnd = NewLabel();   // Label for the end of the loop
-
-        // Place the label for the start of condition check
-        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelStart + ":")); // Add label definition to OPS
-
-        expect("while", "Internal Parser Error: Expected 'while'."); // Keyword while
-        if (hasError)
-            return;
-        expect("(", "Expected '(' after 'while'.");
-        if (hasError)
-            return;
-        Condition(); // Generates OPS for the loop condition
-        expect(")", "Expected ')' after condition.");
-        if (hasError)
-            return;
-
-        // After condition, generate JF jump to exit the loop
-        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelEnd)); // Add label reference to OPS
-        AddToOPS(OPSElement(OPSCode::OP_JF));              // Add JF command
-
-        expect("{", "Expected '{' for while body.");
-        if (hasError)
-            return;
-        StatementList(); // Generates OPS for the loop body
-        expect("}", "Expected '}' after while body.");
-        if (hasError)
-            return;
-
-        // After loop body, generate JMP to return to condition check
-        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelStart)); // Add label reference to OPS
-        AddToOPS(OPSElement(OPSCode::OP_JMP));               // Add JMP command
-
-        // Place the label for the end of the loop
-        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelEnd + ":")); // Add label definition to OPS
-    }
-    else
-    {
-        error("Syntax Error: Expected 'while' or 'for', but got '" + currentToken.str_ + "'.");
-        consume();
-    }
-}
-
-// INOUTPUT -> INPUT | OUTPUT
-void Parser::InOutput()
-{
-    if (hasError)
-        return;
-    // Choose alternative based on current token
-    if (currentToken.type == TokenType::KEYWORD && currentToken.str_ == "read")
-    {
-        Input(); // Parse Input (generates OPS inside)
-    }
-    else if (currentToken.type == TokenType::KEYWORD && currentToken.str_ == "print")
-    {
-        Output(); // Parse Output (generates OPS inside)
-    }
-    else
-    {
-        error("Internal Parser Error: Expected 'read' or 'print'.");
-        consume();
-    }
-}
-
-// INPUT -> READ L_BRACKET ID R_BRACKET
-void Parser::Input()
-{
-    if (hasError)
-        return;
-    expect("read", "Internal Parser Error: Expected 'read'."); // Keyword read
-    if (hasError)
-        return;
-    expect("(", "Expected '(' after 'read'.");
-    if (hasError)
-        return;
-
-    Token value = currentToken;
-    // Semantic action: Add ident name and READ operator
-    expect(TokenType::ID, "Expected identifier after 'read('.");
-    if (hasError)
-        return;
-    AddToOPS(OPSElement(OPSCode::OP_IDENT, value.str_));
-
-    expect(")", "Expected ')' after identifier in 'read'.");
-    if (hasError)
-        return;
-    AddToOPS(OPSElement(OPSCode::OP_READ));
-}
-
-// OUTPUT -> PRINT L_BRACKET EXPRESSION R_BRACKET
-void Parser::Output()
-{
-    if (hasError)
-        return;
-    expect("print", "Internal Parser Error: Expected 'print'."); // Keyword print
-    if (hasError)
-        return;
-    expect("(", "Expected '(' after 'print'.");
-    if (hasError)
-        return;
-
-    Expression(); // Generates OPS for the expression to print
-
-    expect(")", "Expected ')' after expression in 'print'.");
-    if (hasError)
-        return;
-    // Semantic action: Add PRINT operator (after expression)
-    AddToOPS(OPSElement(OPSCode::OP_PRINT));
-}
-
-// EMPTY_STATEMENT -> ε
-// Handled implicitly in StatementList and Statement functions.
-
-// --- Печать сгенерированной ОПС (для отладки) ---
-
-void printOPS(vector<OPSElement> &ops_code)
-{
-    std::cout << "\n--- Generated OPS Code ---" << std::endl;
-    if (ops_code.empty())
-    {
-        std::cout << "(Empty)" << std::endl;
-        return;
-    }
-
-    // Mapping OPSCode to string for printing
-    std::unordered_map<OPSCode, std::string> opsCodeToString = {
-        {OPSCode::OP_INT_CONST, "INT"},
-        {OPSCode::OP_FLOAT_CONST, "FLOAT"},
-        {OPSCode::OP_IDENT, "ID"},
-        {OPSCode::OP_ADD, "+"},
-        {OPSCode::OP_SUB, "-"},
-        {OPSCode::OP_MUL, "*"},
-        {OPSCode::OP_DIV, "/"},
-        {OPSCode::OP_LS, "<"},
-        {OPSCode::OP_LE, "<="},
-        {OPSCode::OP_GS, ">"},
-        {OPSCode::OP_GE, ">="},
-        {OPSCode::OP_EQ, "=="},
-        {OPSCode::OP_NE, "<>"},
-        {OPSCode::OP_JF, "JF"},
-        {OPSCode::OP_JMP, "JMP"},
-        {OPSCode::OP_ASSIGN, "="},
-        {OPSCode::OP_READ, "READ"},
-        {OPSCode::OP_PRINT, "PRINT"},
-        {OPSCode::OP_LABEL, "LABEL"}
-        // Add other ops if needed
-    };
-
-    for (size_t i = 0; i < ops_code.size(); ++i)
-    {
-        const auto &element = ops_code[i];
-        // Print index for easier label reference
-        // std::cout << std::setw(4) << i << ": "; // Optional: print index
-
-        if (element.code == OPSCode::OP_LABEL)
-        {
-            // Label definition
-            std::cout << std::get<std::string>(element.value) << std::endl; // Print label name (e.g., "L1:")
-        }
-        else
-        {
-            // Other elements
-            auto it = opsCodeToString.find(element.code);
-            std::string codeStr = (it != opsCodeToString.end()) ? it->second : "UNKNOWN";
-
-            std::cout << codeStr;
-
-            // Print value based on code type
-            switch (element.code)
-            {
-            case OPSCode::OP_INT_CONST:
-                std::cout << " " << std::get<int>(element.value);
-                break;
-            case OPSCode::OP_FLOAT_CONST:
-                std::cout << " " << std::fixed << std::setprecision(2) << std::get<float>(element.value); // Adjust precision as needed
-                break;
-            case OPSCode::OP_IDENT:
-                std::cout << " " << std::get<std::string>(element.value);
-                break;
-            case OPSCode::OP_JF:
-            case OPSCode::OP_JMP:
-                break;
-                // For Operators (+, -, *, etc.), READ, PRINT, ASSIGN - operands are on the stack, print only the operator
-            case OPSCode::OP_ADD:
-            case OPSCode::OP_SUB:
-            case OPSCode::OP_MUL:
-            case OPSCode::OP_DIV:
-            case OPSCode::OP_LS:
-            case OPSCode::OP_LE:
-            case OPSCode::OP_GS:
-            case OPSCode::OP_GE:
-            case OPSCode::OP_EQ:
-            case OPSCode::OP_NE:
-            case OPSCode::OP_ASSIGN:
-            case OPSCode::OP_READ:
-            case OPSCode::OP_PRINT:
-                // No extra value to print here, operands/targets are handled by stack/previous elements
-                break;
-            case OPSCode::OP_LABEL:
-                // Handled above, prints label name and newline
-                break;
-            default:
-                std::cout << " UNKNOWN_VALUE"; // Fallback
-                break;
-            }
-            // Add space after non-label elements for readability
-            if (element.code != OPSCode::OP_LABEL)
-            {
-                std::cout << " ";
-            }
-        }
-    }
-    std::cout << std::endl; // Final newline
-}
-/*
-// --- Главная функция программы ---
-int main()
-{
-    std::string filename = "test.txt"; // Укажите правильный путь к файлу
-
-    std::string text = convert(filename);
-    cout << text;
-    // Создаем лексер с текстом из файла
-    Lexer lexer(text);
-
-    std::vector<OPSElement> ops_code;
-    // Создаем парсер, передавая ему лексер
-    Parser parser(lexer, ops_code);
-
-    // Запускаем процесс парсинга
-    parser.parse();
-
-    // Печатаем сгенерированную ОПС, если не было ошибок синтаксиса
-    if (!parser.hasSyntaxError())
-    {
-        printOPS(ops_code);
-        // Здесь должен быть вызов функции для интерпретации сгенерированного OPS (Задача 3)
-        // interpret_ops(ops_code);
-        return 0;
-    }
-    return 1; // Возвращаем ненулевой код для ошибки синтаксиса или лексической ошибки
-}
-    */
+#include "syntaxer.h"
+#include <fstream>
+#include <unordered_map>
+#include <cctype>    // For isalpha, isdigit, isalnum, isspace
+#include <stdexcept> // For std::runtime_error, std::invalid_argument, std::out_of_range
+#include <iomanip> // For std::fixed, std::setprecision
+
+namespace translator::detail
+{
+size_t divisionMagic(int d)
+{
+    const uint32_t two31 = 0x80000000u;
+    uint32_t ad = d < 0 ? 0u - static_cast<uint32_t>(d) : static_cast<uint32_t>(d);
+    uint32_t t = two31 + (static_cast<uint32_t>(d) >> 31);
+    uint32_t anc = t - 1 - t % ad; // |d| * k - 1 для наибольшего такого числа не больше t
+    int p = 31;
+    uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc;
+    uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;
+    uint32_t delta;
+    do
+    {
+        p++;
+        q1 = 2 * q1;
+        r1 = 2 * r1;
+        if (r1 >= anc)
+        {
+            q1++;
+            r1 -= anc;
+        }
+        q2 = 2 * q2;
+        r2 = 2 * r2;
+        if (r2 >= ad)
+        {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    uint32_t magic = q2 + 1;
+    if (d < 0)
+        magic = 0u - magic;
+    return static_cast<size_t>(magic) | (static_cast<size_t>(p - 32) << 32);
+}
+
+// --- ГЕНЕРАЦИЯ ОПС (Задача 4) ---
+
+// Вспомогательная функция для добавления элемента в ОПС
+// Перегружена для разных типов значений
+
+void reportUndefinedVariable(std::ostream &err, const VariableUse &use)
+{
+    err << "Semantic Error at Row " << use.row << ", Column " << use.column
+        << ": Variable '" << use.name << "' is used before it is defined." << std::endl;
+}
+
+// Конструктор парсера
+
+Parser::Parser(Lexer &lexer, vector<OPSElement> &ops_code, std::ostream &out, std::ostream &err, std::vector<SourcePosition> *positions)
+    : lexer(lexer), out(out), err(err), hasError(false), currentToken(lexer.getNextToken()), ops_code(ops_code), positions(positions),
+      hasSemanticError(false), label_counter(0)
+{
+    if (positions)
+        positions->clear();
+}
+
+std::string Parser::NewLabel()
+{
+    return "L" + std::to_string(label_counter++);
+}
+
+void Parser::parse()
+{
+    // Проверяем, нет ли ошибок от лексера на первом токене
+    if (hasError)
+    {
+        err << "Parsing aborted due to initial lexical error." << std::endl;
+        return; // Прерываем парсинг, если лексер уже выдал ошибку
+    }
+    // Начинаем разбор с начального символа грамматики (START)
+    Start();
+
+    if (!hasError)
+    {
+        out << "Parsing successful: Syntax is correct." << std::endl;
+        if (hasSemanticError)
+            err << "Semantic analysis failed: variables used before definition." << std::endl;
+    }
+    else
+    {
+        err << "Parsing failed: Syntax errors found." << std::endl;
+    }
+}
+void Parser::AddToOPS(const OPSElement &element)
+{
+    ops_code.push_back(element);
+    if (positions)
+        positions->push_back(last_position);
+}
+void Parser::AddToOPS(const OPSElement &element, const Token &at)
+{
+    ops_code.push_back(element);
+    if (positions)
+        positions->push_back(SourcePosition{at.row + 1, at.column + 1});
+}
+// Получает следующий токен
+void Parser::consume()
+{
+    if (hasError)
+        return;
+    last_position = SourcePosition{currentToken.row + 1, currentToken.column + 1};
+    currentToken = lexer.getNextToken();
+}
+
+// Проверяет тип текущего токена и потребляет его
+void Parser::expect(TokenType expectedType, const std::string &errorMessage)
+{
+    if (hasError)
+        return;
+    if (currentToken.type == expectedType)
+    {
+        consume();
+        return;
+    }
+    error(errorMessage);
+    hasError = true;
+}
+
+// Проверяет значение (для операторов/разделителей/ключевых слов) текущего токена и потребляет его
+void Parser::expect(const std::string &expectedValue, const std::string &errorMessage)
+{
+    if (hasError)
+        return;
+
+    if ((currentToken.type == TokenType::OPERATOR ||
+         currentToken.type == TokenType::DELIMITER ||
+         currentToken.type == TokenType::KEYWORD) &&
+        currentToken.str_ == expectedValue)
+    {
+        consume();
+        return;
+    }
+
+    error(errorMessage);
+    hasError = true;
+}
+
+// Выводит сообщение об ошибке парсинга
+void Parser::error(const std::string &message)
+{
+    if (!hasError)
+    {
+        err << "Syntax Error at Row " << lexer.get_row() + 1 << ", Column " << lexer.get_column() + 1 << ": " << message << std::endl;
+        hasError = true;
+        // В реальном парсере здесь может быть логика восстановления после ошибки
+    }
+}
+
+// Использование переменной в выражении: она должна быть определена на всех путях к этой точке.
+// Проверка делается при разборе, поэтому интерпретатору больше не нужно отслеживать необъявленные переменные.
+void Parser::useVariable(const Token &token)
+{
+    if (hasError || defined_vars.count(token.str_))
+        return;
+    VariableUse use{token.str_, token.row + 1, token.column + 1};
+    if (unresolved)
+        unresolved->push_back(use);
+    else
+    {
+        reportUndefinedVariable(err, use);
+        hasSemanticError = true;
+    }
+    defined_vars.insert(token.str_); // Об одной переменной сообщаем один раз
+}
+
+void Parser::defineVariable(const std::string &name)
+{
+    if (!hasError)
+        defined_vars.insert(name);
+}
+
+// Вспомогательная функция для получения OPSCode из строки оператора
+OPSCode Parser::getOPSCode(const std::string &op_symbol)
+{
+    if (op_symbol == "+")
+        return OPSCode::OP_ADD;
+    if (op_symbol == "-")
+        return OPSCode::OP_SUB;
+    if (op_symbol == "*")
+        return OPSCode::OP_MUL;
+    if (op_symbol == "/")
+        return OPSCode::OP_DIV;
+    if (op_symbol == "<")
+        return OPSCode::OP_LS;
+    if (op_symbol == "<=")
+        return OPSCode::OP_LE;
+    if (op_symbol == ">")
+        return OPSCode::OP_GS;
+    if (op_symbol == ">=")
+        return OPSCode::OP_GE;
+    if (op_symbol == "==")
+        return OPSCode::OP_EQ;
+    if (op_symbol == "<>")
+        return OPSCode::OP_NE;
+    if (op_symbol == "=")
+        return OPSCode::OP_ASSIGN;
+    // ... добавьте другие операторы, если есть (AND, OR, NOT, etc.)
+    // Если оператор не найден, это внутренняя ошибка или ошибка лексера
+    err << "Internal Error: Unknown operator symbol '" << op_symbol << "' in getOPSCode." << std::endl;
+    return OPSCode::OP_ERROR; // Нужен специальный код ошибки, или бросить исключение.
+    // Добавляем фиктивный OP_ERROR в OPSCode enum.
+}
+
+// --- Реализация функций для нетерминалов (по вашей грамматике) ---
+
+bool Parser::atStatementStart() const
+{
+    return currentToken.type == TokenType::ID ||
+           (currentToken.type == TokenType::KEYWORD &&
+            (currentToken.str_ == "if" || currentToken.str_ == "while" || currentToken.str_ == "read" || currentToken.str_ == "print")) ||
+           (currentToken.type == TokenType::DELIMITER && currentToken.str_ == ";");
+}
+
+bool Parser::parseStatement()
+{
+    if (hasError || !atStatementStart())
+        return false;
+    Statement();
+    return !hasError;
+}
+
+// START -> STATEMENT_LIST EOF
+void Parser::Start()
+{
+    if (hasError)
+        return;
+    StatementList();
+}
+
+// STATEMENT_LIST -> STATEMENT STATEMENT_LIST | ε
+void Parser::StatementList()
+{
+    if (hasError)
+        return;
+
+    // Проверяем, есть ли начало оператора
+    if (atStatementStart())
+    {
+        // Разбираем один оператор
+        Statement();
+        // Рекурсивно разбираем остаток списка операторов
+        StatementList();
+    }
+    // Если нет начала оператора, это ε-случай (ничего не делаем)
+}
+
+// STATEMENT -> ASSIGNMENT SC | IFELSE SC | LOOP SC | INPUT SC | OUTPUT SC | SC
+void Parser::Statement()
+{
+    if (hasError)
+        return;
+
+    if (currentToken.type == TokenType::ID)
+    {
+        // Оператор присваивания
+        Assignment();
+        expect(";", "Expected ';' after assignment statement.");
+    }
+    else if (currentToken.type == TokenType::KEYWORD)
+    {
+        if (currentToken.str_ == "if")
+        {
+            Ifelse();
+        }
+        else if (currentToken.str_ == "while")
+        {
+            Loop();
+        }
+        else if (currentToken.str_ == "read" || currentToken.str_ == "print")
+        {
+            InOutput();
+        }
+        else
+        {
+            error("Syntax Error: Unexpected keyword '" + currentToken.str_ + "'.");
+            consume();
+        }
+        expect(";", "Expected ';' after control statement.");
+    }
+    else if (currentToken.type == TokenType::DELIMITER && currentToken.str_ == ";")
+    {
+        // Пустой оператор
+        expect(";", "Internal Parser Error: Expected ';'.");
+    }
+    else
+    {
+        error("Syntax Error: Expected start of a statement (ID, keyword, or ';'), but got token type " +
+              std::to_string(static_cast<int>(currentToken.type)));
+        consume();
+    }
+}
+
+// ASSIGNMENT -> ID ASSIGN EXPRESSION
+void Parser::Assignment()
+{
+    if (hasError)
+        return;
+    Token target = currentToken; // Присваивание в профиле относится к началу оператора
+    const std::string &var_name = target.str_;
+    expect(TokenType::ID, "Expected identifier in assignment.");
+
+    if (hasError)
+        return;
+
+    expect("=", "Expected '=' in assignment.");
+    if (hasError)
+        return;
+
+    Expression(); // Generates OPS for the expression
+
+    // Semantic actions (after expression OPS is generated)
+    AddToOPS(OPSElement(OPSCode::OP_IDENT, var_name), target); // Variable (where to assign)
+    AddToOPS(OPSElement(OPSCode::OP_ASSIGN), target);          // Assignment operator
+    defineVariable(var_name);                                  // Right side is checked before the target becomes defined
+}
+
+// EXPRESSION -> TERM U
+void Parser::Expression()
+{
+    if (hasError)
+        return;
+    Term(); // Generates OPS for the first Term
+    U();    // Generates OPS for the rest (+/-)
+}
+
+// U -> ADD TERM U | SUB TERM U | ε
+void Parser::U()
+{
+    if (hasError)
+        return;
+    // Check for '+' or '-' operator
+    if (currentToken.type == TokenType::OPERATOR && (currentToken.str_ == "+" || currentToken.str_ == "-"))
+    {
+        std::string op_val = currentToken.str_;                        // Capture operator symbol
+        expect(op_val, "Internal Parser Error: Expected '+' or '-'."); // Consume the operator
+        if (hasError)
+            return;
+
+        Term(); // Generates OPS for the next Term
+
+        U(); // Recurse for the rest of the tail
+
+        // Semantic action (after operands and tail are parsed)
+        AddToOPS(OPSElement(getOPSCode(op_val))); // Add the operator to OPS
+    }
+    // Epsilon case (nothing to do) is implicit when the token is not '+' or '-'
+    // Follow set of U: {;, ), }, <, <=, >, >=, ==, <>, (AND, OR, NOT?), EOF}
+}
+
+// TERM -> FACTOR V
+void Parser::Term()
+{
+    if (hasError)
+        return;
+    Factor(); // Generates OPS for the Factor
+    V();      // Generates OPS for the rest (*, /)
+}
+
+// V -> MUL FACTOR V | DIV FACTOR V | ε
+void Parser::V()
+{
+    if (hasError)
+        return;
+    // Check for '*' or '/' operator
+    if (currentToken.type == TokenType::OPERATOR && (currentToken.str_ == "*" || currentToken.str_ == "/"))
+    {
+        std::string op_val = currentToken.str_;                        // Capture operator symbol
+        expect(op_val, "Internal Parser Error: Expected '*' or '/'."); // Consume the operator
+        if (hasError)
+            return;
+
+        Factor(); // Generates OPS for the next Factor
+
+        V(); // Recurse for the rest of the tail
+
+        // Semantic action (after operands and tail are parsed)
+        AddToOPS(OPSElement(getOPSCode(op_val))); // Add the operator to OPS
+    }
+    // Epsilon case is implicit
+    // Follow set of V: {+, -, ;, ), }, <, <=, >, >=, ==, <>, (AND, OR, NOT?), EOF}
+}
+
+// FACTOR -> ID | INT_CONST | FLOAT_CONST | L_BRACKET EXPRESSION R_BRACKET
+void Parser::Factor()
+{
+    if (hasError)
+        return;
+
+    if (currentToken.type == TokenType::DELIMITER && currentToken.str_ == "(")
+    {
+        expect("(", "Expected '(' in factor.");
+        Expression(); // Рекурсивно разбираем выражение внутри скобок
+        expect(")", "Expected ')' after expression in factor.");
+        return;
+
+        // Семантические действия: скобки только управляют порядком вычислений, не генерируют дополнительные команды
+    }
+    else if (currentToken.type == TokenType::ID)
+    {
+        useVariable(currentToken);
+        AddToOPS(OPSElement(OPSCode::OP_IDENT, currentToken.str_), currentToken);
+        expect(TokenType::ID, "Expected identifier in factor.");
+        return;
+    }
+    else if (currentToken.type == TokenType::INT_CONST)
+    {
+        AddToOPS(OPSElement(OPSCode::OP_INT_CONST, currentToken.int_), currentToken);
+        expect(TokenType::INT_CONST, "Expected integer constant in factor.");
+        return;
+    }
+    else if (currentToken.type == TokenType::FLOAT_CONST)
+    {
+        AddToOPS(OPSElement(OPSCode::OP_FLOAT_CONST, currentToken.flo_), currentToken);
+        expect(TokenType::FLOAT_CONST, "Expected float constant in factor.");
+        return;
+    }
+
+    else
+    {
+        error("Syntax Error: Expected identifier, number, or '(' in factor.");
+        consume();
+    }
+}
+
+// COMPOP -> LS | LE | GS | GE | EQ | NE
+// This non-terminal is handled directly within Condition function.
+
+// CONDITION -> EXPRESSION COMPOP EXPRESSION
+void Parser::Condition()
+{
+    if (hasError)
+        return;
+    Expression(); // Generates OPS for the left side of the comparison
+
+    // Check and consume the comparison operator
+    if (currentToken.type == TokenType::OPERATOR)
+    {
+        std::string op_val = currentToken.str_; // Capture operator symbol
+        if (op_val == "<" || op_val == "<=" || op_val == ">" || op_val == ">=" || op_val == "==" || op_val == "<>")
+        {
+            expect(op_val, "Internal Parser Error: Expected comparison operator."); // Consume the operator
+            if (hasError)
+                return;
+            Expression(); // Generates OPS for the right side of the comparison
+
+            // Semantic action (after both expressions are parsed)
+            AddToOPS(OPSElement(getOPSCode(op_val))); // Add the comparison operator to OPS
+        }
+        else
+        {
+            error("Syntax Error: Expected comparison operator (<, <=, >, >=, ==, <>), but got '" + op_val + "'.");
+            consume();
+        }
+    }
+    else
+    {
+        error("Syntax Error: Expected comparison operator after expression in condition.");
+        consume();
+    }
+}
+
+// IFELSE -> IF_STATEMENT L_BRACKET CONDITION R_BRACKET L_BODY STATEMENT_LIST R_BODY ELSE_STATEMENT L_BODY STATEMENT_LIST R_BODY
+//        | IF_STATEMENT L_BRACKET CONDITION R_BRACKET L_BODY STATEMENT_LIST R_BODY
+void Parser::Ifelse()
+{
+    if (hasError)
+        return;
+    expect("if", "Internal Parser Error: Expected 'if'."); // Keyword if
+    if (hasError)
+        return;
+    expect("(", "Expected '(' after 'if'.");
+    if (hasError)
+        return;
+    Condition(); // Generates OPS for the condition
+    expect(")", "Expected ')' after condition.");
+    if (hasError)
+        return;
+
+    // --- Semantic actions for the IF part ---
+    // After condition, generate JF jump based on condition result
+    std::string labelElse = NewLabel();                 // Label for the start of the else block (or end of if)
+    AddToOPS(OPSElement(OPSCode::OP_LABEL, labelElse)); // Add label reference to OPS
+    AddToOPS(OPSElement(OPSCode::OP_JF));               // Add JF command
+
+    // Definite assignment: after if-else only variables defined in both branches are defined
+    std::unordered_set<std::string> definedBefore = defined_vars;
+
+    expect("{", "Expected '{' for if body.");
+    if (hasError)
+        return;
+    StatementList(); // Generates OPS for the 'then' block
+    expect("}", "Expected '}' after if body.");
+    if (hasError)
+        return;
+    std::unordered_set<std::string> definedThen;
+    definedThen.swap(defined_vars);
+    defined_vars = definedBefore;
+    std::string labelEnd; // Set only when there is an else block
+    if (currentToken.type == TokenType::KEYWORD && currentToken.str_ == "else")
+    {
+        // --- Semantic actions for the ELSE part ---
+        // Before the else block, generate a JMP to skip the else block if 'if' was true
+        labelEnd = NewLabel();                             // Label for the very end of if-else
+        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelEnd)); // Add label reference to OPS
+        AddToOPS(OPSElement(OPSCode::OP_JMP));             // Add JMP command
+
+        // Place the label for the start of the else block
+        //  AddToOPS(OPSElement(OPSCode::OP_LABEL, ":")); // Add label definition to OPS
+
+        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelElse + ":"));
+
+        expect("else", "Internal Parser Error: Expected 'else'."); // Keyword else
+        if (hasError)
+            return;
+        expect("{", "Expected '{' for else body.");
+        if (hasError)
+            return;
+        StatementList(); // Generates OPS for the 'else' block
+        expect("}", "Expected '}' after else body.");
+        if (hasError)
+            return;
+        // The else label is already placed, the jump over the else block lands here
+        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelEnd + ":"));
+    }
+    else
+        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelElse + ":")); // Add label definition to OPS
+
+    // Without else the 'else' path is definedBefore itself, so the intersection is definedBefore
+    for (auto it = defined_vars.begin(); it != defined_vars.end();)
+    {
+        if (definedThen.count(*it))
+            ++it;
+        else
+            it = defined_vars.erase(it);
+    }
+}
+// LOOP -> WHILE_STATEMENT L_BRACKET CONDITION R_BRACKET L_BODY STATEMENT_LIST R_BODY
+//      | FOR_STATEMENT L_BRACKET STATEMENT CONDITION SC STATEMENT R_BRACKET L_BODY STATEMENT_LIST R_BODY
+void Parser::Loop()
+{
+    if (hasError)
+        return;
+    if (currentToken.type == TokenType::KEYWORD && currentToken.str_ == "while")
+    {
+        // --- Semantic actions for WHILE ---
+        std::string labelStart = NewLabel(); // Label for the start of condition check
+        std::string labelEnd = NewLabel();   // Label for the end of the loop
+
+        // Place the label for the start of condition check
+        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelStart + ":")); // Add label definition to OPS
+
+        // Definite assignment: the body may run zero times, so its assignments do not survive the loop
+        std::unordered_set<std::string> definedBefore = defined_vars;
+
+        expect("while", "Internal Parser Error: Expected 'while'."); // Keyword while
+        if (hasError)
+            return;
+        expect("(", "Expected '(' after 'while'.");
+        if (hasError)
+            return;
+        Condition(); // Generates OPS for the loop condition
+        expect(")", "Expected ')' after condition.");
+        if (hasError)
+            return;
+
+        // After condition, generate JF jump to exit the loop
+        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelEnd)); // Add label reference to OPS
+        AddToOPS(OPSElement(OPSCode::OP_JF));              // Add JF command
+
+        expect("{", "Expected '{' for while body.");
+        if (hasError)
+            return;
+        StatementList(); // Generates OPS for the loop body
+        expect("}", "Expected '}' after while body.");
+        if (hasError)
+            return;
+
+        // After loop body, generate JMP to return to condition check
+        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelStart)); // Add label reference to OPS
+        AddToOPS(OPSElement(OPSCode::OP_JMP));               // Add JMP command
+
+        // Place the label for the end of the loop
+        AddToOPS(OPSElement(OPSCode::OP_LABEL, labelEnd + ":")); // Add label definition to OPS
+        defined_vars.swap(definedBefore);
+    }
+    else
+    {
+        error("Syntax Error: Expected 'while' or 'for', but got '" + currentToken.str_ + "'.");
+        consume();
+    }
+}
+
+// INOUTPUT -> INPUT | OUTPUT
+void Parser::InOutput()
+{
+    if (hasError)
+        return;
+    // Choose alternative based on current token
+    if (currentToken.type == TokenType::KEYWORD && currentToken.str_ == "read")
+    {
+        Input(); // Parse Input (generates OPS inside)
+    }
+    else if (currentToken.type == TokenType::KEYWORD && currentToken.str_ == "print")
+    {
+        Output(); // Parse Output (generates OPS inside)
+    }
+    else
+    {
+        error("Internal Parser Error: Expected 'read' or 'print'.");
+        consume();
+    }
+}
+
+// INPUT -> READ L_BRACKET ID R_BRACKET
+void Parser::Input()
+{
+    if (hasError)
+        return;
+    expect("read", "Internal Parser Error: Expected 'read'."); // Keyword read
+    if (hasError)
+        return;
+    expect("(", "Expected '(' after 'read'.");
+    if (hasError)
+        return;
+
+    Token value = currentToken;
+    // Semantic action: Add ident name and READ operator
+    expect(TokenType::ID, "Expected identifier after 'read('.");
+    if (hasError)
+        return;
+    AddToOPS(OPSElement(OPSCode::OP_IDENT, value.str_), value);
+    defineVariable(value.str_);
+
+    expect(")", "Expected ')' after identifier in 'read'.");
+    if (hasError)
+        return;
+    AddToOPS(OPSElement(OPSCode::OP_READ));
+}
+
+// OUTPUT -> PRINT L_BRACKET EXPRESSION R_BRACKET
+void Parser::Output()
+{
+    if (hasError)
+        return;
+    expect("print", "Internal Parser Error: Expected 'print'."); // Keyword print
+    if (hasError)
+        return;
+    expect("(", "Expected '(' after 'print'.");
+    if (hasError)
+        return;
+
+    Expression(); // Generates OPS for the expression to print
+
+    expect(")", "Expected ')' after expression in 'print'.");
+    if (hasError)
+        return;
+    // Semantic action: Add PRINT operator (after expression)
+    AddToOPS(OPSElement(OPSCode::OP_PRINT));
+}
+
+// EMPTY_STATEMENT -> ε
+// Handled implicitly in StatementList and Statement functions.
+
+// --- Печать сгенерированной ОПС (для отладки) ---
+
+void printOPS(vector<OPSElement> &ops_code, std::ostream &out)
+{
+    out << "\n--- Generated OPS Code ---" << std::endl;
+    if (ops_code.empty())
+    {
+        out << "(Empty)" << std::endl;
+        return;
+    }
+
+    // Mapping OPSCode to string for printing
+    std::unordered_map<OPSCode, std::string> opsCodeToString = {
+        {OPSCode::OP_INT_CONST, "INT"},
+        {OPSCode::OP_FLOAT_CONST, "FLOAT"},
+        {OPSCode::OP_IDENT, "ID"},
+        {OPSCode::OP_ADD, "+"},
+        {OPSCode::OP_SUB, "-"},
+        {OPSCode::OP_MUL, "*"},
+        {OPSCode::OP_DIV, "/"},
+        {OPSCode::OP_MUL_POW2, "*<<"},
+        {OPSCode::OP_DIV_CONST, "/c"},
+        {OPSCode::OP_LS, "<"},
+        {OPSCode::OP_LE, "<="},
+        {OPSCode::OP_GS, ">"},
+        {OPSCode::OP_GE, ">="},
+        {OPSCode::OP_EQ, "=="},
+        {OPSCode::OP_NE, "<>"},
+        {OPSCode::OP_JF, "JF"},
+        {OPSCode::OP_JT, "JT"},
+        {OPSCode::OP_JMP, "JMP"},
+        {OPSCode::OP_ASSIGN, "="},
+        {OPSCode::OP_READ, "READ"},
+        {OPSCode::OP_PRINT, "PRINT"},
+        {OPSCode::OP_LABEL, "LABEL"}
+        // Add other ops if needed
+    };
+
+    for (size_t i = 0; i < ops_code.size(); ++i)
+    {
+        const auto &element = ops_code[i];
+        // Print index for easier label reference
+        // out << std::setw(4) << i << ": "; // Optional: print index
+
+        if (element.code == OPSCode::OP_LABEL)
+        {
+            // Label definition
+            out << std::get<std::string>(element.value) << std::endl; // Print label name (e.g., "L1:")
+        }
+        else
+        {
+            // Other elements
+            auto it = opsCodeToString.find(element.code);
+            std::string codeStr = (it != opsCodeToString.end()) ? it->second : "UNKNOWN";
+
+            out << codeStr;
+
+            // Print value based on code type
+            switch (element.code)
+            {
+            case OPSCode::OP_INT_CONST:
+                out << " " << std::get<int>(element.value);
+                break;
+            case OPSCode::OP_FLOAT_CONST:
+                out << " " << std::fixed << std::setprecision(2) << std::get<float>(element.value); // Adjust precision as needed
+                break;
+            case OPSCode::OP_IDENT:
+                out << " " << std::get<std::string>(element.value);
+                break;
+            case OPSCode::OP_JF:
+            case OPSCode::OP_JT:
+            case OPSCode::OP_JMP:
+                break;
+            case OPSCode::OP_MUL_POW2:
+                out << std::get<size_t>(element.value); // Сдвиг: "INT 8 *<<3"
+                break;
+            case OPSCode::OP_DIV_CONST:
+                break; // Делитель - константа перед операцией, магическое число не печатаем
+                // For Operators (+, -, *, etc.), READ, PRINT, ASSIGN - operands are on the stack, print only the operator
+            case OPSCode::OP_ADD:
+            case OPSCode::OP_SUB:
+            case OPSCode::OP_MUL:
+            case OPSCode::OP_DIV:
+            case OPSCode::OP_LS:
+            case OPSCode::OP_LE:
+            case OPSCode::OP_GS:
+            case OPSCode::OP_GE:
+            case OPSCode::OP_EQ:
+            case OPSCode::OP_NE:
+            case OPSCode::OP_READ:
+            case OPSCode::OP_PRINT:
+                // Optimized OPS may carry the name shown to the user: PRINT[x], PRINT[] prints without a name
+                if (std::holds_alternative<std::string>(element.value))
+                    out << "[" << std::get<std::string>(element.value) << "]";
+                break;
+            case OPSCode::OP_ASSIGN:
+                // No extra value to print here, operands/targets are handled by stack/previous elements
+                break;
+            case OPSCode::OP_LABEL:
+                // Handled above, prints label name and newline
+                break;
+            default:
+                out << " UNKNOWN_VALUE"; // Fallback
+                break;
+            }
+            // Add space after non-label elements for readability
+            if (element.code != OPSCode::OP_LABEL)
+            {
+                out << " ";
+            }
+        }
+    }
+    out << std::endl; // Final newline
+}
+/*
+// --- Главная функция программы ---
+int main()
+{
+    std::string filename = "test.txt"; // Укажите правильный путь к файлу
+
+    std::string text = convert(filename);
+    cout << text;
+    // Создаем лексер с текстом из файла
+    Lexer lexer(text);
+
+    std::vector<OPSElement> ops_code;
+    // Создаем парсер, передавая ему лексер
+    Parser parser(lexer, ops_code);
+
+    // Запускаем процесс парсинга
+    parser.parse();
+
+    // Печатаем сгенерированную ОПС, если не было ошибок синтаксиса
+    if (!parser.hasSyntaxError())
+    {
+        printOPS(ops_code);
+        // Здесь должен быть вызов функции для интерпретации сгенерированного OPS (Задача 3)
+        // interpret_ops(ops_code);
+        return 0;
+    }
+    return 1; // Возвращаем ненулевой код для ошибки синтаксиса или лексической ошибки
+}
+    */
+} // namespace translator::detail
@@ -0,0 +1,173 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <variant>
+#include <cstdint>
+#include "lexer.h"
+
+namespace translator::detail
+{
+// --- ОПРЕДЕЛЕНИЕ ФОРМАТА ОПС (Задача 6) ---
+// Перечисление для кодов операций ОПС
+enum class OPSCode
+{
+    // Операнды (специальные маркеры, чтобы знать, что находится в value)
+    OP_INT_CONST,   // value is int_
+    OP_FLOAT_CONST, // value is flo_
+    OP_IDENT,       // value is str_
+
+    // Арифметические
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+
+    // Умножение и деление на целую константу (ставит оптимизатор, константа - второй операнд на стеке)
+    OP_MUL_POW2,  // value is size_t: константа = 2^value, целое умножается сдвигом
+    OP_DIV_CONST, // value is size_t: магическое число для деления умножением (см. divisionMagic)
+
+    // Сравнения
+    OP_LS,
+    OP_LE,
+    OP_GS,
+    OP_GE,
+    OP_EQ,
+    OP_NE,
+
+    // Управление потоком
+    OP_JF,  // Условный переход (Jump if Zero)
+    OP_JT,  // Переход, если условие истинно (ставит оптимизатор)
+    OP_JMP, // Безусловный переход
+
+    // Память
+    OP_ASSIGN, // Присваивание
+
+    // Ввод/Вывод
+    OP_READ,  // value (если string) - имя переменной в приглашении
+    OP_PRINT, // value (если string) - имя при печати, "" - печать без имени
+
+    OP_ERROR,
+
+    // Метки (для переходов)
+    OP_LABEL // value is int_ (индекс в векторе OPS)
+};
+
+// Структура для одного элемента в последовательности ОПС
+struct OPSElement
+{
+    OPSCode code; // Код операции или тип операнда
+
+    // Значение элемента. Используем variant для гибкости.
+    std::variant<int, float, std::string, size_t> value; // int/float для констант, string для имен переменных, size_t для адресов меток (индексов в векторе)
+
+    OPSElement(OPSCode c, int v) : code(c), value(v) {}
+    OPSElement(OPSCode c, float v) : code(c), value(v) {}
+    OPSElement(OPSCode c, const std::string &v) : code(c), value(v) {}
+    OPSElement(OPSCode c, size_t v) : code(c), value(v) {}
+    OPSElement(OPSCode c) : code(c) {} // Для операций без явного значения (JMP, JF, +, =, etc.)
+};
+
+// Где в исходном тексте появился элемент ОПС (строка и столбец с единицы, 0 - неизвестно).
+// Таблица позиций идёт параллельно ops_code: positions[i] - позиция ops_code[i].
+struct SourcePosition
+{
+    size_t row = 0;
+    size_t column = 0;
+};
+
+// Значение OP_DIV_CONST для делителя d (|d| >= 2): магическое число M в младших 32 битах, сдвиг s в старших.
+// n / d = (старшая половина M * n с поправкой на знаки) >> s, округление к нулю как у "/" (Hacker's Delight, гл. 10).
+size_t divisionMagic(int d);
+
+// Использование переменной до присваивания: имя и позиция (с единицы)
+struct VariableUse
+{
+    std::string name;
+    size_t row, column;
+};
+
+void reportUndefinedVariable(std::ostream &err, const VariableUse &use);
+
+// --- СИНТАКСИЧЕСКИЙ АНАЛИЗАТОР (ПАРСЕР) ---
+// (Рекурсивный спуск с генерацией ОПС)
+
+class Parser
+{
+private:
+    Lexer &lexer;       // Ссылка на лексер
+    std::ostream &out;  // Куда писать сообщение об успешном разборе
+    std::ostream &err;  // Куда писать ошибки
+    bool hasError;      // Флаг ошибки парсинга
+    Token currentToken; // Текущий токен от лексера
+    std::vector<OPSElement> &ops_code;
+    std::vector<SourcePosition> *positions; // Таблица позиций для профилировщика, nullptr - не нужна
+    SourcePosition last_position;           // Последняя разобранная лексема: там кончается конструкция, чей элемент выпускается
+
+    // Анализ определённости переменных (definite assignment).
+    // Множество переменных, которые получили значение на любом пути до текущей точки разбора.
+    std::unordered_set<std::string> defined_vars;
+    bool hasSemanticError; // Найдено использование переменной до присваивания
+    std::vector<VariableUse> *unresolved = nullptr; // Не ошибки, а кандидаты - см. deferUndefinedVariables
+
+    // Счётчик меток свой у каждого парсера: разбор не трогает глобального состояния
+    size_t label_counter;
+    std::string NewLabel(); // Вспомогательная функция для генерации уникальных меток
+
+    // Вспомогательные функции
+    void expect(TokenType expectedType, const std::string &errorMessage);
+    void expect(const std::string &expectedValue, const std::string &errorMessage);
+    void consume();
+    bool atStatementStart() const; // Текущая лексема может начинать оператор
+    void error(const std::string &message);
+    void useVariable(const Token &token);           // Проверка, что переменная определена
+    void defineVariable(const std::string &name); // Переменная получила значение
+
+    // Функции для каждого нетерминала грамматики
+    void Start();
+    void StatementList();
+    void Statement();
+    void Assignment();
+    void Expression();
+    void U(); // Для + и - хвоста выражения
+    void Term();
+    void V(); // Для * и / хвоста выражения
+    void Factor();
+    void Condition();
+    // COMPOP не нужна как отдельная функция
+    void Ifelse();
+    void Loop();
+    void InOutput(); // Объединяет Input и Output
+    void Input();
+    void Output();
+    void AddToOPS(const OPSElement &element);
+    void AddToOPS(const OPSElement &element, const Token &at); // Позиция - лексема at (операнды)
+    // EmptyStatement не нужна как отдельная функция
+
+    // Вспомогательная функция для получения OPSCode из строки оператора
+    OPSCode getOPSCode(const std::string &op_symbol);
+
+public:
+    Parser(Lexer &lexer, vector<OPSElement> &ops_code, std::ostream &out = std::cout, std::ostream &err = std::cerr,
+           std::vector<SourcePosition> *positions = nullptr); // Конструктор
+    void parse();
+    // Разбирает один оператор верхнего уровня и дописывает его ОПС (--stream выполняет её и очищает ops_code).
+    // false - операторов больше нет или синтаксическая ошибка; сообщений об успешном разборе нет.
+    bool parseStatement();
+    bool hasSyntaxError() const { return hasError; }
+    bool hasSemanticErrors() const { return hasSemanticError; }
+    // Разбор куска программы (fragments.cpp): переменные, не определённые в самом куске, не ошибка, а записываются
+    // в target по порядку - определены ли они до куска, проверяет склейка
+    void deferUndefinedVariables(std::vector<VariableUse> *target) { unresolved = target; }
+    const std::unordered_set<std::string> &definedVariables() const { return defined_vars; }
+    // Кусок продолжает текст, где последней разобрана лексема в previous: её позицию получают элементы до первой лексемы куска
+    void continueAfter(const SourcePosition &previous) { last_position = previous; }
+    size_t labelCount() const { return label_counter; } // Выданы метки L0 .. L(labelCount() - 1)
+    bool atEnd() const { return currentToken.type == TokenType::TOKEN_EOF; }
+};
+
+// Печать сгенерированной ОПС (--print-ops, listing() библиотеки); включает у out fixed с двумя знаками,
+// если в ОПС есть вещественная константа
+void printOPS(vector<OPSElement> &ops_code, std::ostream &out = std::cout);
+} // namespace translator::detail
@@ -0,0 +1,119 @@
+#include "trace.h"
+#include <fstream>
+#include <cstring> // Для memcpy
+
+namespace translator::detail
+{
+uint64_t programHash(const vector<OPSElement> &ops_code)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](const void *data, size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+    };
+    for (const OPSElement &element : ops_code)
+    {
+        int code = static_cast<int>(element.code);
+        mix(&code, sizeof(code));
+        if (holds_alternative<int>(element.value))
+            mix(&get<int>(element.value), sizeof(int));
+        else if (holds_alternative<float>(element.value))
+            mix(&get<float>(element.value), sizeof(float));
+        else if (holds_alternative<size_t>(element.value))
+            mix(&get<size_t>(element.value), sizeof(size_t));
+        else
+            mix(get<string>(element.value).data(), get<string>(element.value).size() + 1);
+    }
+    return hash;
+}
+
+bool ExecutionTrace::save(const string &path) const
+{
+    ofstream out(path, ios::binary);
+    auto put = [&](uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+    };
+    out.write("OPSTRC1\n", 8);
+    put(program_hash, 8);
+    put(instructions, 8);
+    put(inputs.size(), 8);
+    for (const auto &value : inputs)
+    {
+        uint32_t bits;
+        if (holds_alternative<int>(value))
+            bits = static_cast<uint32_t>(get<int>(value));
+        else
+            memcpy(&bits, &get<float>(value), sizeof(bits));
+        put(holds_alternative<int>(value) ? 0 : 1, 1);
+        put(bits, 4);
+    }
+    put(branch_count, 8);
+    out.write(reinterpret_cast<const char *>(branches.data()), static_cast<streamsize>(branches.size()));
+    return static_cast<bool>(out);
+}
+
+bool ExecutionTrace::load(const string &path, string &error)
+{
+    ifstream in(path, ios::binary);
+    if (!in)
+    {
+        error = "The trace file was not found: " + path;
+        return false;
+    }
+    auto get_u = [&](size_t size)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i)
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(in.get())) << (8 * i);
+        return value;
+    };
+    char magic[8];
+    if (!in.read(magic, 8) || memcmp(magic, "OPSTRC1\n", 8) != 0)
+    {
+        error = "Not a trace file: " + path;
+        return false;
+    }
+    program_hash = get_u(8);
+    instructions = get_u(8);
+    uint64_t input_count = get_u(8);
+    inputs.clear();
+    for (uint64_t i = 0; i < input_count && in; ++i)
+    {
+        bool is_float = get_u(1) != 0;
+        uint32_t bits = static_cast<uint32_t>(get_u(4));
+        if (is_float)
+        {
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            inputs.push_back(value);
+        }
+        else
+            inputs.push_back(static_cast<int>(bits));
+    }
+    branch_count = get_u(8);
+    streamoff here = in.tellg();
+    in.seekg(0, ios::end);
+    uint64_t left = in ? static_cast<uint64_t>(in.tellg() - here) : 0;
+    in.seekg(here);
+    if (branch_count > left * 8) // Испорченный счётчик не должен выделять гигабайты
+    {
+        error = "The trace file is truncated: " + path;
+        return false;
+    }
+    branches.assign(static_cast<size_t>((branch_count + 7) / 8), 0);
+    in.read(reinterpret_cast<char *>(branches.data()), static_cast<streamsize>(branches.size()));
+    if (!in)
+    {
+        error = "The trace file is truncated: " + path;
+        return false;
+    }
+    replaying = true;
+    next_input = 0;
+    next_branch = 0;
+    return true;
+}
+} // namespace translator::detail
@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <variant>
+#include <cstdint>
+#include "syntaxer.h"
+
+namespace translator::detail
+{
+// --- ТРАССА ВЫПОЛНЕНИЯ (--record / --replay) ---
+// Запись: все значения read() и исход каждого условного перехода (JF/JT) - по биту на переход. Последовательность PC
+// этим задана полностью: остальные инструкции идут подряд или прыгают безусловно, поэтому хранить сами PC не нужно.
+// Воспроизведение: та же ОПС (проверяется по хешу) выполняется со значениями из трассы, без терминала, и каждый
+// переход сверяется с записанным - первое расхождение останавливает выполнение с номером перехода.
+//
+// Файл (числа little-endian): "OPSTRC1\n", u64 хеш ОПС, u64 инструкций, u64 значений и по значению u8 тип (0 - int,
+// 1 - float) + 4 байта, u64 переходов и биты исходов по 8 в байте, младший бит - первый переход.
+
+// FNV-1a по кодам и операндам элементов: трасса подходит только к той ОПС, на которой записана (-O и --unroll меняют ОПС)
+uint64_t programHash(const vector<OPSElement> &ops_code);
+
+struct ExecutionTrace
+{
+    uint64_t program_hash = 0;
+    uint64_t instructions = 0;          // Выполнено инструкций за записанный запуск
+    vector<variant<int, float>> inputs; // Значения read() по порядку
+    vector<uint8_t> branches;           // Исходы переходов, 1 - переход выполнен
+    uint64_t branch_count = 0;
+
+    bool replaying = false;             // Сверять исходы с записанными, а не дописывать
+    size_t next_input = 0;
+    uint64_t next_branch = 0;           // Сколько переходов уже сверено
+
+    // Условный переход выполнен (taken) или нет; false - при воспроизведении исход другой, чем в трассе
+    bool branch(bool taken)
+    {
+        if (!replaying)
+        {
+            if (branch_count % 8 == 0)
+                branches.push_back(0);
+            if (taken)
+                branches.back() |= static_cast<uint8_t>(1u << (branch_count % 8));
+            ++branch_count;
+            return true;
+        }
+        if (next_branch >= branch_count)
+        {
+            ++next_branch; // Номер для сообщения - как у записанных
+            return false;
+        }
+        bool recorded = (branches[next_branch / 8] >> (next_branch % 8)) & 1u;
+        ++next_branch;
+        return recorded == taken;
+    }
+
+    bool save(const string &path) const;
+    // false - файла нет или он не трасса; error объясняет
+    bool load(const string &path, string &error);
+};
+} // namespace translator::detail
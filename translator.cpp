@@ -0,0 +1,209 @@
+// --- БИБЛИОТЕКА ---
+// Реализация translator.h поверх того же конвейера, что и в interpreter: лексер -> парсер -> оптимизатор -> интерпретатор.
+// Сообщения этапов собираются в строку, ввод-вывод идёт через обработчики Context.
+#include <deque>
+#include <sstream>
+#include "interpreter.h"
+#include "translator.h"
+
+// Конвейер - отдельные единицы трансляции библиотеки в пространстве имён translator::detail: Lexer, Parser,
+// Interpreter и остальное не столкнутся с одноимёнными классами хоста, а снаружи видно только translator:: из translator.h.
+namespace translator
+{
+using namespace detail;
+
+struct Program::Code
+{
+    bool ok = false;
+    std::string diagnostics;
+    std::string listing;
+    std::vector<OPSElement> ops;
+    FloatFormat float_format{std::chars_format::general, 6};
+};
+
+namespace
+{
+// Обработчики хоста в роли RuntimeIO
+class CallbackIO : public RuntimeIO
+{
+private:
+    Context &context;
+    std::deque<Value> *supplied; // Значения от Execution::supply(), nullptr - без приостановки
+
+public:
+    explicit CallbackIO(Context &ctx, std::deque<Value> *pending_values = nullptr) : context(ctx), supplied(pending_values) {}
+
+    ReadStatus read(const std::string &name, std::variant<int, float, std::string> &value, std::string &error) override
+    {
+        Value read_val;
+        if (supplied && !supplied->empty())
+        {
+            read_val = supplied->front();
+            supplied->pop_front();
+        }
+        else if (!context.read || !context.read(name, read_val))
+        {
+            if (supplied)
+                return ReadStatus::Pending;
+            error = "Runtime Error: No input for variable '" + name + "'.";
+            return ReadStatus::Failed;
+        }
+        if (std::holds_alternative<int>(read_val))
+            value = std::get<int>(read_val);
+        else
+            value = std::get<float>(read_val);
+        return ReadStatus::Ready;
+    }
+    void print(const std::string &name, const std::variant<int, float, std::string> &value) override
+    {
+        if (!context.print)
+            return;
+        if (std::holds_alternative<int>(value))
+            context.print(name, Value(std::get<int>(value)));
+        else
+            context.print(name, Value(std::get<float>(value)));
+    }
+};
+
+RunLimits limitsOf(const Context &context)
+{
+    RunLimits limits;
+    limits.max_instructions = context.max_instructions;
+    limits.max_time = context.max_time;
+    return limits;
+}
+
+const std::string empty_text;
+} // namespace
+
+Program compile(const std::string &source, const CompileOptions &options)
+{
+    auto code = std::make_shared<Program::Code>();
+    std::ostringstream messages;
+    OptimizerOptions optimizer_options;
+    optimizer_options.unroll_factor = options.unroll_factor;
+    code->ok = compileSource(source, code->ops, code->float_format, messages, options.optimize ? &optimizer_options : nullptr);
+    if (code->ok)
+    {
+        std::ostringstream listing;
+        printOPS(code->ops, listing);
+        code->listing = listing.str();
+    }
+    code->diagnostics = messages.str();
+    return Program(code);
+}
+
+bool Program::ok() const
+{
+    return code && code->ok;
+}
+
+const std::string &Program::diagnostics() const
+{
+    return code ? code->diagnostics : empty_text;
+}
+
+const std::string &Program::listing() const
+{
+    return code ? code->listing : empty_text;
+}
+
+bool Program::run(Context &context) const
+{
+    context.error.clear();
+    if (!ok())
+    {
+        context.error = "Program was not compiled successfully.";
+        return false;
+    }
+    CallbackIO io(context);
+    Interpreter inter(code->ops);
+    if (inter.run(io, limitsOf(context)))
+        return true;
+    context.error = inter.error();
+    return false;
+}
+
+struct Execution::State
+{
+    std::shared_ptr<const Program::Code> code; // Держит ОПС, на которую ссылается inter
+    std::deque<Value> supplied;
+    std::unique_ptr<CallbackIO> io;            // Пересоздаётся на каждый resume(): context может быть другим
+    std::unique_ptr<Interpreter> inter;
+    bool started = false;
+    bool done = false;
+};
+
+Execution::Execution(const Program &program) : state(std::make_unique<State>())
+{
+    state->code = program.code;
+    if (state->code && state->code->ok)
+        state->inter = std::make_unique<Interpreter>(state->code->ops);
+}
+
+Execution::~Execution() = default;
+Execution::Execution(Execution &&) noexcept = default;
+Execution &Execution::operator=(Execution &&) noexcept = default;
+
+Execution::Status Execution::resume(Context &context, std::size_t max_instructions)
+{
+    context.error.clear();
+    if (!state->inter)
+    {
+        context.error = "Program was not compiled successfully.";
+        return Status::Failed;
+    }
+    if (state->done)
+    {
+        context.error = "Execution has already finished.";
+        return Status::Failed;
+    }
+    state->io = std::make_unique<CallbackIO>(context, &state->supplied);
+    if (!state->started)
+    {
+        state->inter->start(*state->io, limitsOf(context));
+        state->started = true;
+    }
+    else
+        state->inter->attach(*state->io);
+    switch (state->inter->resume(max_instructions))
+    {
+    case RunStatus::Yielded:
+        return Status::Yielded;
+    case RunStatus::NeedsInput:
+        return Status::NeedsInput;
+    case RunStatus::Finished:
+        state->done = true;
+        return Status::Finished;
+    case RunStatus::LimitExceeded:
+        state->done = true;
+        context.error = state->inter->error();
+        return Status::LimitExceeded;
+    case RunStatus::Failed:
+        break;
+    }
+    state->done = true;
+    context.error = state->inter->error();
+    return Status::Failed;
+}
+
+const std::string &Execution::pendingInput() const
+{
+    return state->inter ? state->inter->pendingInput() : empty_text;
+}
+
+void Execution::supply(const Value &value)
+{
+    state->supplied.push_back(value);
+}
+
+std::string Program::format(const Value &value) const
+{
+    FloatFormat float_format = code ? code->float_format : FloatFormat{std::chars_format::general, 6};
+    char text[64];
+    char *end = std::holds_alternative<int>(value)
+                    ? std::to_chars(text, text + sizeof(text), std::get<int>(value)).ptr
+                    : std::to_chars(text, text + sizeof(text), std::get<float>(value), float_format.format, float_format.precision).ptr;
+    return std::string(text, end);
+}
+} // namespace translator
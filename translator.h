@@ -0,0 +1,113 @@
+#pragma once
+// --- ВСТРАИВАЕМЫЙ ИНТЕРФЕЙС ТРАНСЛЯТОРА ---
+// Программа компилируется один раз (compile) и выполняется сколько угодно раз (Program::run).
+// Процессного изменяемого состояния нет: скомпилированная Program неизменна, её можно хранить в кэше
+// и выполнять одновременно из многих потоков, у каждого выполнения свой Context.
+//
+//     translator::Program program = translator::compile("read(x); print(x * 2);");
+//     translator::Context context;
+//     context.read = [](const std::string &, translator::Value &value) { value = 21; return true; };
+//     context.print = [&](const std::string &name, const translator::Value &value)
+//     { std::cout << name << " = " << program.format(value) << "\n"; };
+//     if (!program.run(context))
+//         std::cerr << context.error << "\n";
+//
+// Если значения для read() ещё нет (ввод приходит по сети, от пользователя), выполнение можно приостановить:
+//
+//     translator::Execution execution(program);
+//     while (execution.resume(context) == translator::Execution::Status::NeedsInput)
+//         execution.supply(waitForValue(execution.pendingInput()));
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <variant>
+
+namespace translator
+{
+using Value = std::variant<int, float>;
+
+struct CompileOptions
+{
+    bool optimize = false; // Прогнать ОПС через оптимизатор (как -O)
+    int unroll_factor = 4; // Во сколько раз разворачивать счётные циклы (как --unroll=N)
+};
+
+// Ввод-вывод одного выполнения: обработчики задаёт хост
+struct Context
+{
+    // read(name, value): значение для переменной name; false - значения нет, выполнение останавливается ошибкой
+    std::function<bool(const std::string &name, Value &value)> read;
+    // print(name, value): name пустое, если печатается выражение без имени
+    std::function<void(const std::string &name, const Value &value)> print;
+    std::string error; // Почему остановилось последнее выполнение, пустое - без ошибок
+
+    // Ограничения для чужих программ (0 - нет): выполнение останавливается ошибкой "Limit Error: ..."
+    // с числом выполненных инструкций. Проверяются на переходах назад и read/print, а не на каждой инструкции.
+    std::size_t max_instructions = 0;
+    std::chrono::milliseconds max_time{0};
+};
+
+class Program
+{
+public:
+    Program() {} // Пустая программа: ok() == false
+
+    bool ok() const;                        // Компиляция прошла без ошибок
+    const std::string &diagnostics() const; // Сообщения лексера, парсера и оптимизатора
+    const std::string &listing() const;     // ОПС текстом, как её печатает interpreter
+
+    // Выполнение с чистыми переменными. false - остановлено ошибкой, текст в context.error.
+    bool run(Context &context) const;
+
+    // Число так, как его печатает interpreter: если в программе есть вещественные константы - "1.50"
+    std::string format(const Value &value) const;
+
+private:
+    struct Code;
+    std::shared_ptr<const Code> code; // Общая и неизменная для всех копий Program
+
+    explicit Program(std::shared_ptr<const Code> compiled) : code(std::move(compiled)) {}
+    friend Program compile(const std::string &source, const CompileOptions &options);
+    friend class Execution;
+};
+
+// Одно выполнение Program, которое можно останавливать и продолжать. Всё состояние (позиция в ОПС, стек,
+// переменные) хранится здесь, поток между вызовами resume() не занят: тысячи ожидающих ввода выполнений
+// обслуживаются несколькими потоками из цикла событий хоста. Одно Execution - из одного потока за раз.
+class Execution
+{
+public:
+    enum class Status
+    {
+        Finished,     // Программа дошла до конца
+        Failed,       // Остановлена ошибкой, текст в context.error
+        Yielded,      // Выполнено max_instructions инструкций, можно продолжать
+        NeedsInput,   // read() ждёт значения: supply() и снова resume()
+        LimitExceeded // Исчерпаны context.max_instructions или context.max_time, текст в context.error
+    };
+
+    explicit Execution(const Program &program);
+    ~Execution();
+    Execution(Execution &&) noexcept;
+    Execution &operator=(Execution &&) noexcept;
+
+    // Продолжает выполнение с места остановки, не больше max_instructions инструкций (0 - без ограничения).
+    // Ограничения context.max_instructions и context.max_time берутся при первом resume() и считаются от него.
+    // read() берёт сначала значения из supply(), затем context.read; если нет ни того, ни другого
+    // (context.read пуст или вернул false) - Status::NeedsInput.
+    Status resume(Context &context, std::size_t max_instructions = 0);
+
+    // Имя переменной, которой ждёт read() после Status::NeedsInput
+    const std::string &pendingInput() const;
+    // Значение для следующего read(); можно передать несколько заранее
+    void supply(const Value &value);
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+};
+
+Program compile(const std::string &source, const CompileOptions &options = CompileOptions());
+} // namespace translator